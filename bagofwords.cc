@@ -6,6 +6,7 @@
 #include <unistd.h>
 
 #include "heap.h"
+#include "pool.h"
 #include "table.h"
 
 struct node {
@@ -23,21 +24,20 @@ struct node {
         ;;
   }
 
-  void kill() { if (!bound()) delete this; }
-
   typedef lite::heap<node, &node::heap_link, typeof(node::count), &node::count, lace::reverse_compare<typeof(node::count)> > heap_t;
   typedef lite::table<node, &node::table_link, typeof(node::string), &node::string> table_t;
 };
 
 int
 main(int argc, char* argv[]) {
+  lite::pool<node> nodes;
   node::table_t::bucket_t buckets[unsigned(sqrt(argc))];
   node::table_t table(buckets, sizeof(buckets)/sizeof(*buckets));
 
   for (int i = 1 ; i < argc ; ++i) {
     node* x = table.get(argv[i]);
     if (!x)
-      table.set(x = new node(argv[i]));
+      table.set(x = new (nodes.allocate()) node(argv[i]));
     ++x->count;
   }
 
@@ -48,7 +48,6 @@ main(int argc, char* argv[]) {
   while (!heap.empty()) {
     node* x = table.bus(heap.exhume());
     std::cout << x->count << " " << x->string << std::endl;
-    x->kill();
   }
 
   return EXIT_SUCCESS;
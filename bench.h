@@ -0,0 +1,168 @@
+#ifndef LITE__BENCH_H
+#define LITE__BENCH_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <stdint.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef __linux__
+#include <cstring>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// harness shared by the bench_* programs; not installed
+namespace bench {
+
+// last-level cache misses of this thread, where perf events are permitted
+class misses {
+public:
+  misses() : fd_(-1) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+
+  ~misses() { if (available()) close(fd_); }
+
+  bool available() const { return fd_ >= 0; }
+
+  void start() {
+#ifdef __linux__
+    if (available()) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  long long stop() {
+    long long n = -1;
+#ifdef __linux__
+    if (available()) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &n, sizeof(n)) != sizeof(n))
+        n = -1;
+    }
+#endif
+    return n;
+  }
+
+private:
+  int fd_;
+};
+
+struct sample {
+  double ns;
+  double misses;
+};
+
+// times one pass of f over ops operations
+template <typename F>
+sample
+measure(size_t ops, F f) {
+  typedef std::chrono::steady_clock clock;
+
+  misses m;
+  m.start();
+  clock::time_point start = clock::now();
+  f();
+  clock::duration elapsed = clock::now() - start;
+  long long n = m.stop();
+
+  sample s;
+  s.ns = std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+  s.misses = n < 0 ? -1 : double(n) / ops;
+  return s;
+}
+
+// keeps the compiler from discarding a result
+template <typename T>
+inline void
+keep(T const & t) {
+  asm volatile("" : : "g"(&t) : "memory");
+}
+
+// xorshift, so that every run sees the same keys
+class random {
+public:
+  random(uint64_t seed = 88172645463325252ULL) : state_(seed | 1) { }
+
+  uint64_t operator()() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return state_;
+  }
+
+private:
+  uint64_t state_;
+};
+
+// the first n naturals, shuffled
+inline std::vector<unsigned>
+permutation(size_t n, uint64_t seed) {
+  random rng(seed);
+  std::vector<unsigned> keys(n);
+  for (size_t i = 0 ; i < n ; ++i)
+    keys[i] = i;
+  for (size_t i = n ; i > 1 ; --i)
+    std::swap(keys[i - 1], keys[rng() % i]);
+  return keys;
+}
+
+// sizes run from 10^3 up to the limit given as the first argument
+inline size_t
+limit(int argc, char* argv[], size_t fallback = 1000000) {
+  return argc > 1 ? strtoull(argv[1], NULL, 0) : fallback;
+}
+
+inline void
+header() {
+  std::cout << std::left
+    << std::setw(12) << "container"
+    << std::setw(12) << "op"
+    << std::right
+    << std::setw(12) << "n"
+    << std::setw(12) << "ns/op"
+    << std::setw(12) << "miss/op"
+    << std::setw(12) << "B/node"
+    << std::endl;
+}
+
+inline void
+report(const char* container, const char* op, size_t n, const sample & s, double bytes) {
+  std::cout << std::left
+    << std::setw(12) << container
+    << std::setw(12) << op
+    << std::right << std::fixed << std::setprecision(2)
+    << std::setw(12) << n
+    << std::setw(12) << s.ns;
+
+  if (s.misses < 0)
+    std::cout << std::setw(12) << "-";
+  else
+    std::cout << std::setw(12) << s.misses;
+
+  std::cout << std::setw(12) << bytes << std::endl;
+}
+
+} // namespace bench
+
+#endif//LITE__BENCH_H
@@ -0,0 +1,204 @@
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench.h"
+#include "btree.h"
+#include "heap.h"
+#include "table.h"
+#include "tree.h"
+
+struct table_node {
+  unsigned key;
+  table_node(unsigned k) : key(k) { }
+
+  lite::table_link<table_node> link;
+  typedef lite::table<table_node, &table_node::link, typeof(table_node::key), &table_node::key> table_t;
+};
+
+struct tree_node {
+  unsigned key;
+  tree_node(unsigned k) : key(k) { }
+
+  lite::tree_link<tree_node> link;
+  typedef lite::tree<tree_node, &tree_node::link, typeof(tree_node::key), &tree_node::key> tree_t;
+};
+
+struct btree_node {
+  unsigned key;
+  btree_node(unsigned k) : key(k) { }
+
+  lite::btree_link<btree_node> link;
+  typedef lite::btree<btree_node, &btree_node::link, typeof(btree_node::key), &btree_node::key> btree_t;
+};
+
+struct heap_node {
+  unsigned key;
+  heap_node(unsigned k) : key(k) { }
+
+  lite::heap_link<heap_node> link;
+  typedef lite::heap<heap_node, &heap_node::link, typeof(heap_node::key), &heap_node::key> heap_t;
+};
+
+template <class N>
+N*
+allocate(const std::vector<unsigned> & keys) {
+  N* nodes = static_cast<N*>(operator new(keys.size() * sizeof(N)));
+  for (size_t i = 0 ; i < keys.size() ; ++i)
+    new (&nodes[i]) N(keys[i]);
+  return nodes;
+}
+
+void
+table(const std::vector<unsigned> & keys, const std::vector<unsigned> & order) {
+  const size_t n = keys.size();
+  table_node* nodes = allocate<table_node>(keys);
+
+  table_node::table_t t;
+  t.reseat(n);
+  const double bytes = sizeof(table_node) + double(t.buckets() * sizeof(table_node::table_t::bucket_t)) / n;
+
+  bench::report("table", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      t.set(&nodes[i]);
+  }), bytes);
+
+  bench::report("table", "lookup", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      bench::keep(t.get(order[i]));
+  }), bytes);
+
+  bench::report("table", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (table_node* x = t.iterator() ; x ; x = t.next(x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("table", "delete", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      t.bus(&nodes[order[i]]);
+  }), bytes);
+
+  t.reseat();
+  operator delete(nodes);
+}
+
+void
+tree(const std::vector<unsigned> & keys, const std::vector<unsigned> & order) {
+  const size_t n = keys.size();
+  tree_node* nodes = allocate<tree_node>(keys);
+  const double bytes = sizeof(tree_node);
+
+  tree_node::tree_t t;
+
+  bench::report("tree", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      t.graft(&nodes[i]);
+  }), bytes);
+
+  bench::report("tree", "lookup", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      bench::keep(t.find(order[i]));
+  }), bytes);
+
+  bench::report("tree", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (tree_node* x = t.min() ; x ; x = t.next(x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("tree", "delete", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      t.prune(&nodes[order[i]]);
+  }), bytes);
+
+  operator delete(nodes);
+}
+
+// leaves run about two-thirds full, & inner nodes add little beyond that
+void
+btree(const std::vector<unsigned> & keys, const std::vector<unsigned> & order) {
+  typedef btree_node::btree_t btree_t;
+
+  const size_t n = keys.size();
+  btree_node* nodes = allocate<btree_node>(keys);
+  const double bytes = sizeof(btree_node) + (sizeof(unsigned) + sizeof(btree_node*)) * 1.5;
+
+  btree_t t;
+
+  bench::report("btree", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      t.graft(&nodes[i]);
+  }), bytes);
+
+  bench::report("btree", "lookup", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      bench::keep(t.find(order[i]));
+  }), bytes);
+
+  bench::report("btree", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (btree_node* x = t.min() ; x ; x = t.next(x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("btree", "delete", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      t.prune(&nodes[order[i]]);
+  }), bytes);
+
+  operator delete(nodes);
+}
+
+// a heap has no lookup by key, & deletes only at the root
+void
+heap(const std::vector<unsigned> & keys) {
+  const size_t n = keys.size();
+  heap_node* nodes = allocate<heap_node>(keys);
+  const double bytes = sizeof(heap_node);
+
+  heap_node::heap_t h;
+
+  bench::report("heap", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      h.inhume(&nodes[i]);
+  }), bytes);
+
+  bench::report("heap", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (heap_node* x = h.root() ; x ; x = h.next(x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("heap", "delete", n, bench::measure(n, [&] {
+    while (!h.empty())
+      bench::keep(h.exhume());
+  }), bytes);
+
+  operator delete(nodes);
+}
+
+int
+main(int argc, char* argv[]) {
+  const size_t limit = bench::limit(argc, argv);
+
+  bench::header();
+  for (size_t n = 1000 ; n <= limit ; n *= 10) {
+    const std::vector<unsigned> keys = bench::permutation(n, 1);
+    const std::vector<unsigned> order = bench::permutation(n, 2);
+
+    table(keys, order);
+    tree(keys, order);
+    btree(keys, order);
+    heap(keys);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//
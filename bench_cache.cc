@@ -0,0 +1,95 @@
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench.h"
+#include "cache.h"
+
+struct node {
+  unsigned key;
+  node(unsigned k) : key(k) { }
+
+  lite::table_link<node> index_link;
+  lite::list_link<node> recency_link;
+  lite::cache_mark<node> cache_mark;
+
+  typedef lite::lru_cache<node, &node::index_link, &node::recency_link,
+                          typeof(node::key), &node::key> lru_cache_t;
+  typedef lite::clock_cache<node, &node::index_link, &node::recency_link, &node::cache_mark,
+                            typeof(node::key), &node::key> clock_cache_t;
+  typedef lite::slru_cache<node, &node::index_link, &node::recency_link, &node::cache_mark,
+                           typeof(node::key), &node::key> slru_cache_t;
+};
+
+// nine accesses in ten go to a tenth of the keys, the rest to any key
+std::vector<unsigned>
+skewed(size_t n, uint64_t seed) {
+  bench::random rng(seed);
+  const size_t hot = n / 10 ? n / 10 : 1;
+  std::vector<unsigned> accesses(n);
+  for (size_t i = 0 ; i < n ; ++i)
+    accesses[i] = rng() % 10 ? rng() % hot : rng() % n;
+  return accesses;
+}
+
+template <class C>
+void
+cache(const char* container, node* nodes, const std::vector<unsigned> & order,
+      const std::vector<unsigned> & accesses) {
+  const size_t n = order.size();
+
+  // every key resident, so each access is a hit
+  {
+    C c(n);
+    for (size_t i = 0 ; i < n ; ++i)
+      c.put(&nodes[i]);
+
+    bench::report(container, "hit", n, bench::measure(n, [&] {
+      for (size_t i = 0 ; i < n ; ++i)
+        bench::keep(c.get(order[i]));
+    }), sizeof(node));
+
+    c.fell();
+  }
+
+  // room for a fifth of the keys, with a miss putting the key's node
+  {
+    C c(n / 5 ? n / 5 : 1);
+
+    bench::report(container, "skewed", n, bench::measure(n, [&] {
+      for (size_t i = 0 ; i < n ; ++i)
+        if (!c.get(accesses[i]))
+          c.put(&nodes[accesses[i]]);
+    }), sizeof(node));
+
+    c.fell();
+  }
+}
+
+// lookups in each cache, where lru relinks on every hit, clock sets a
+// bit, & slru relinks only on promotion
+int
+main(int argc, char* argv[]) {
+  const size_t limit = bench::limit(argc, argv);
+
+  bench::header();
+  for (size_t n = 1000 ; n <= limit ; n *= 10) {
+    const std::vector<unsigned> order = bench::permutation(n, 2);
+    const std::vector<unsigned> accesses = skewed(n, 3);
+
+    node* nodes = static_cast<node*>(operator new(n * sizeof(node)));
+    for (size_t i = 0 ; i < n ; ++i)
+      new (&nodes[i]) node(i);
+
+    cache<node::lru_cache_t>("lru", nodes, order, accesses);
+    cache<node::clock_cache_t>("clock", nodes, order, accesses);
+    cache<node::slru_cache_t>("slru", nodes, order, accesses);
+
+    operator delete(nodes);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//
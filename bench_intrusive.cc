@@ -0,0 +1,156 @@
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench.h"
+#include "set.h"
+#include "stack.h"
+
+struct stack_node {
+  unsigned key;
+  stack_node(unsigned k) : key(k) { }
+
+  lite::stack_link<stack_node> link;
+  typedef lite::stack<stack_node, &stack_node::link> stack_t;
+};
+
+struct set_node {
+  unsigned key;
+  set_node(unsigned k) : key(k) { }
+
+  lite::set_link<set_node> link;
+  typedef lite::set<set_node, &set_node::link> set_t;
+};
+
+struct forest_node {
+  unsigned key;
+  forest_node(unsigned k) : key(k) { }
+
+  lite::forest_link<forest_node> link;
+  typedef lite::forest<forest_node, &forest_node::link> forest_t;
+};
+
+template <class N>
+N*
+allocate(const std::vector<unsigned> & keys) {
+  N* nodes = static_cast<N*>(operator new(keys.size() * sizeof(N)));
+  for (size_t i = 0 ; i < keys.size() ; ++i)
+    new (&nodes[i]) N(keys[i]);
+  return nodes;
+}
+
+void
+stack(const std::vector<unsigned> & keys) {
+  const size_t n = keys.size();
+  stack_node* nodes = allocate<stack_node>(keys);
+  const double bytes = sizeof(stack_node);
+
+  stack_node::stack_t s;
+
+  bench::report("stack", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      s.push(&nodes[keys[i]]);
+  }), bytes);
+
+  bench::report("stack", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (stack_node* x = s.iterator() ; x ; x = s.next(x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("stack", "delete", n, bench::measure(n, [&] {
+    while (!s.empty())
+      bench::keep(s.pop());
+  }), bytes);
+
+  operator delete(nodes);
+}
+
+// a set is one class, so lookup is a membership test
+void
+set(const std::vector<unsigned> & keys, const std::vector<unsigned> & order) {
+  const size_t n = keys.size();
+  set_node* nodes = allocate<set_node>(keys);
+  const double bytes = sizeof(set_node) + double(sizeof(set_node::set_t)) / n;
+
+  set_node::set_t s;
+
+  bench::report("set", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      s.join(&nodes[keys[i]]);
+  }), bytes);
+
+  bench::report("set", "lookup", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      bench::keep(s.contains(&nodes[order[i]]));
+  }), bytes);
+
+  bench::report("set", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (set_node* x = s.iterator() ; x ; x = s.next(x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("set", "delete", n, bench::measure(n, [&] {
+    s.dissolve();
+  }), bytes);
+
+  operator delete(nodes);
+}
+
+// each node joins one chosen earlier at random, building one class by
+// unions of every size; lookup finds the archetype
+void
+forest(const std::vector<unsigned> & keys, const std::vector<unsigned> & order) {
+  typedef forest_node::forest_t forest_t;
+
+  const size_t n = keys.size();
+  forest_node* nodes = allocate<forest_node>(keys);
+  const double bytes = sizeof(forest_node);
+
+  bench::report("forest", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 1 ; i < n ; ++i)
+      forest_t::join(&nodes[keys[i]], &nodes[keys[order[i] % i]]);
+  }), bytes);
+
+  bench::report("forest", "lookup", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      bench::keep(forest_t::archetype(&nodes[order[i]]));
+  }), bytes);
+
+  forest_node* start = &nodes[0];
+  bench::report("forest", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (forest_node* x = start ; x ; x = forest_t::next(start, x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("forest", "delete", n, bench::measure(n, [&] {
+    forest_t::dissolve(start);
+  }), bytes);
+
+  operator delete(nodes);
+}
+
+int
+main(int argc, char* argv[]) {
+  const size_t limit = bench::limit(argc, argv);
+
+  bench::header();
+  for (size_t n = 1000 ; n <= limit ; n *= 10) {
+    const std::vector<unsigned> keys = bench::permutation(n, 1);
+    const std::vector<unsigned> order = bench::permutation(n, 2);
+
+    stack(keys);
+    set(keys, order);
+    forest(keys, order);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//
@@ -0,0 +1,109 @@
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench.h"
+#include "list.h"
+#include "queue.h"
+
+struct list_node {
+  unsigned key;
+  list_node(unsigned k) : key(k) { }
+
+  lite::list_link<list_node> link;
+  typedef lite::list<list_node, &list_node::link> list_t;
+};
+
+struct queue_node {
+  unsigned key;
+  queue_node(unsigned k) : key(k) { }
+
+  lite::queue_link<queue_node> link;
+  typedef lite::queue<queue_node, &queue_node::link> queue_t;
+};
+
+template <class N>
+N*
+allocate(const std::vector<unsigned> & keys) {
+  N* nodes = static_cast<N*>(operator new(keys.size() * sizeof(N)));
+  for (size_t i = 0 ; i < keys.size() ; ++i)
+    new (&nodes[i]) N(keys[i]);
+  return nodes;
+}
+
+// nodes are linked in shuffled order, so iteration strides through memory
+// as it would after any real churn; deletion is in a second order
+void
+list(const std::vector<unsigned> & keys, const std::vector<unsigned> & order) {
+  const size_t n = keys.size();
+  list_node* nodes = allocate<list_node>(keys);
+  const double bytes = sizeof(list_node);
+
+  list_node::list_t l;
+
+  bench::report("list", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      l.enlist(&nodes[keys[i]]);
+  }), bytes);
+
+  bench::report("list", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (list_node* x = l.first() ; x ; x = l.next(x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("list", "delete", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      l.delist(&nodes[order[i]]);
+  }), bytes);
+
+  operator delete(nodes);
+}
+
+void
+queue(const std::vector<unsigned> & keys) {
+  const size_t n = keys.size();
+  queue_node* nodes = allocate<queue_node>(keys);
+  const double bytes = sizeof(queue_node);
+
+  queue_node::queue_t q;
+
+  bench::report("queue", "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      q.enqueue(&nodes[keys[i]]);
+  }), bytes);
+
+  bench::report("queue", "iterate", n, bench::measure(n, [&] {
+    unsigned sum = 0;
+    for (queue_node* x = q.iterator() ; x ; x = q.next(x))
+      sum += x->key;
+    bench::keep(sum);
+  }), bytes);
+
+  bench::report("queue", "delete", n, bench::measure(n, [&] {
+    while (!q.empty())
+      bench::keep(q.dequeue());
+  }), bytes);
+
+  operator delete(nodes);
+}
+
+int
+main(int argc, char* argv[]) {
+  const size_t limit = bench::limit(argc, argv);
+
+  bench::header();
+  for (size_t n = 1000 ; n <= limit ; n *= 10) {
+    const std::vector<unsigned> keys = bench::permutation(n, 1);
+    const std::vector<unsigned> order = bench::permutation(n, 2);
+
+    list(keys, order);
+    queue(keys);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//
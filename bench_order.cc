@@ -0,0 +1,116 @@
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench.h"
+#include "heap.h"
+#include "queue.h"
+#include "tree.h"
+
+// the natural order, but opaque to lite::order, so containers given it
+// branch on a three-way result as they would for any other comparator
+lace::compare_t
+ordered(int const & foo, int const & bar) {
+  return (bar < foo) - (foo < bar);
+}
+
+struct node {
+  int key;
+  node(int k) : key(k) { }
+
+  lite::tree_link<node> tree_link;
+  lite::heap_link<node> heap_link;
+  lite::queue_link<node> queue_link;
+
+  typedef lite::queue<node, &node::queue_link> queue_t;
+};
+
+template <lace::compare_t (*C)(int const &, int const &)>
+struct with {
+  typedef lite::tree<node, &node::tree_link, typeof(node::key), &node::key, C> tree_t;
+  typedef lite::heap<node, &node::heap_link, typeof(node::key), &node::key, C> heap_t;
+  typedef node::queue_t::sorter<typeof(node::key), &node::key, C> sorter_t;
+};
+
+template <lace::compare_t (*C)(int const &, int const &)>
+void
+tree(const char* container, node* nodes, const std::vector<unsigned> & order) {
+  typename with<C>::tree_t t;
+  const size_t n = order.size();
+
+  for (size_t i = 0 ; i < n ; ++i)
+    t.graft(&nodes[i]);
+
+  bench::report(container, "lookup", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      bench::keep(t.find(order[i]));
+  }), sizeof(node));
+
+  for (size_t i = 0 ; i < n ; ++i)
+    t.prune(&nodes[i]);
+}
+
+template <lace::compare_t (*C)(int const &, int const &)>
+void
+heap(const char* container, node* nodes, const std::vector<unsigned> & order) {
+  typename with<C>::heap_t h;
+  const size_t n = order.size();
+
+  bench::report(container, "insert", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      h.inhume(&nodes[order[i]]);
+  }), sizeof(node));
+
+  bench::report(container, "delete", n, bench::measure(n, [&] {
+    while (!h.empty())
+      bench::keep(h.exhume());
+  }), sizeof(node));
+}
+
+template <lace::compare_t (*C)(int const &, int const &)>
+void
+sort(const char* container, node* nodes, const std::vector<unsigned> & order) {
+  node::queue_t q;
+  const size_t n = order.size();
+
+  for (size_t i = 0 ; i < n ; ++i)
+    q.enqueue(&nodes[order[i]]);
+
+  bench::report(container, "sort", n, bench::measure(n, [&] {
+    with<C>::sorter_t::sort(q);
+  }), sizeof(node));
+
+  while (!q.empty())
+    q.dequeue();
+}
+
+// int-keyed containers through a comparator call, & through lite::order's
+// builtin operators
+int
+main(int argc, char* argv[]) {
+  const size_t limit = bench::limit(argc, argv);
+
+  bench::header();
+  for (size_t n = 1000 ; n <= limit ; n *= 10) {
+    const std::vector<unsigned> keys = bench::permutation(n, 1);
+    const std::vector<unsigned> order = bench::permutation(n, 2);
+
+    node* nodes = static_cast<node*>(operator new(n * sizeof(node)));
+    for (size_t i = 0 ; i < n ; ++i)
+      new (&nodes[i]) node(keys[i]);
+
+    tree<ordered>("tree/call", nodes, order);
+    tree<lace::compare<int> >("tree/order", nodes, order);
+    heap<ordered>("heap/call", nodes, order);
+    heap<lace::compare<int> >("heap/order", nodes, order);
+    sort<ordered>("sort/call", nodes, order);
+    sort<lace::compare<int> >("sort/order", nodes, order);
+
+    operator delete(nodes);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//
@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include <unistd.h>
+
+#include <lace/compare.h>
+#include <lace/singleton.h>
+#include <lace/random.h>
+#include "queue.h"
+
+// node touches are counted as comparisons, each of which reads a new
+// node, plus nodes walked only to find where to split a run
+
+static unsigned long long comparisons = 0;
+static unsigned long long walks = 0;
+
+lace::compare_t
+counting_compare(int const & foo, int const & bar) {
+  ++comparisons;
+  return lace::compare(foo, bar);
+}
+
+struct node {
+  int value;
+  node(int v) : value(v) { }
+
+  lite::queue_link<node> queue_link;
+
+  bool
+  bound() const {
+    return false
+        || queue_link.bound()
+        ;;
+  }
+
+  typedef lite::queue<node, &node::queue_link> queue_t;
+  typedef queue_t::sorter<typeof(value), &node::value, counting_compare> sorter_t;
+};
+
+// the strided bottom-up sort which queue::sorter::sort used to be
+node::queue_t &
+strided_sort(node::queue_t & q) {
+  for (unsigned stride = 1 ; q.size() > stride ; stride *= 2) {
+    node::queue_t that;
+    while (q.size() > stride) {
+      node::queue_t foo, bar;
+
+      walks += stride;
+      foo.chain(q, stride);
+
+      if (q.size() > stride)
+        walks += stride;
+      bar.chain(q, stride);
+
+      node::sorter_t::merge(that, foo, bar);
+    }
+
+    if (!q.empty())
+      that.chain(q);
+
+    q.chain(that);
+  }
+
+  return q;
+}
+
+template <node::queue_t & (*S)(node::queue_t &)>
+void
+measure(const char * name, node* nodes, unsigned n) {
+  lace::random & rng = lace::singleton<lace::random>::instance();
+
+  node::queue_t q;
+  for (unsigned i = 0 ; i < n ; ++i)
+    q.enqueue(new (&nodes[i]) node(rng.l()));
+
+  comparisons = walks = 0;
+
+  typedef std::chrono::steady_clock clock;
+  clock::time_point start = clock::now();
+  S(q);
+  clock::duration elapsed = clock::now() - start;
+
+  if (!node::sorter_t::sorted(q))
+    std::cerr << name << " unsorted" << std::endl, abort();
+
+  while (!q.empty())
+    q.dequeue()->~node();
+
+  std::cout << std::setw(12) << name
+    << std::setw(12) << n
+    << std::setw(12) << double(comparisons) / n
+    << std::setw(12) << double(walks) / n
+    << std::setw(12) << double(comparisons + walks) / n
+    << std::setw(12) << std::chrono::duration<double, std::nano>(elapsed).count() / n
+    << std::endl;
+}
+
+int
+main(int argc, char* argv[]) {
+  const unsigned limit = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+
+  std::cout << std::setw(12) << "sort"
+    << std::setw(12) << "n"
+    << std::setw(12) << "cmp/n"
+    << std::setw(12) << "walk/n"
+    << std::setw(12) << "touch/n"
+    << std::setw(12) << "ns/n"
+    << std::endl;
+
+  for (unsigned n = 1000 ; n <= limit ; n *= 10) {
+    node* nodes = static_cast<node*>(operator new(n * sizeof(node)));
+    measure<strided_sort>("strided", nodes, n);
+    measure<node::sorter_t::sort>("sorter", nodes, n);
+    operator delete(nodes);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//
@@ -0,0 +1,89 @@
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench.h"
+#include "btree.h"
+#include "tree.h"
+
+// the natural order, but not lace::compare, so btree falls back on a
+// binary search through the comparator
+lace::compare_t
+ordered(unsigned const & foo, unsigned const & bar) {
+  return (bar < foo) - (foo < bar);
+}
+
+struct node {
+  unsigned key;
+  node(unsigned k) : key(k) { }
+
+  lite::tree_link<node> tree_link;
+  lite::btree_link<node> btree_link;
+
+  typedef lite::tree<node, &node::tree_link, typeof(node::key), &node::key> tree_t;
+  typedef lite::btree<node, &node::btree_link, typeof(node::key), &node::key, ordered> search_t;
+  typedef lite::btree<node, &node::btree_link, typeof(node::key), &node::key> scan_t;
+};
+
+template <class N>
+N*
+allocate(const std::vector<unsigned> & keys) {
+  N* nodes = static_cast<N*>(operator new(keys.size() * sizeof(N)));
+  for (size_t i = 0 ; i < keys.size() ; ++i)
+    new (&nodes[i]) N(keys[i]);
+  return nodes;
+}
+
+template <class C>
+void
+lookup(const char* container, node* nodes, const std::vector<unsigned> & order) {
+  const size_t n = order.size();
+  C c;
+
+  for (size_t i = 0 ; i < n ; ++i)
+    c.graft(&nodes[i]);
+
+  bench::report(container, "lookup", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      bench::keep(c.find(order[i]));
+  }), sizeof(node));
+
+  // misses are looked for between the keys, which are all even
+  bench::report(container, "miss", n, bench::measure(n, [&] {
+    for (size_t i = 0 ; i < n ; ++i)
+      bench::keep(c.find(order[i] + 1));
+  }), sizeof(node));
+
+  for (size_t i = 0 ; i < n ; ++i)
+    c.prune(&nodes[i]);
+}
+
+// lookups by integer key in tree, & in btree searching its nodes with the
+// comparator or with the vector scan of btree_count
+int
+main(int argc, char* argv[]) {
+  const size_t limit = bench::limit(argc, argv);
+
+  bench::header();
+  for (size_t n = 1000 ; n <= limit ; n *= 10) {
+    std::vector<unsigned> keys = bench::permutation(n, 1);
+    std::vector<unsigned> order = bench::permutation(n, 2);
+    for (size_t i = 0 ; i < n ; ++i) {
+      keys[i] *= 2;
+      order[i] *= 2;
+    }
+
+    node* nodes = allocate<node>(keys);
+
+    lookup<node::tree_t>("tree", nodes, order);
+    lookup<node::search_t>("btree/bin", nodes, order);
+    lookup<node::scan_t>("btree/scan", nodes, order);
+
+    operator delete(nodes);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//
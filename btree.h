@@ -0,0 +1,696 @@
+#ifndef LITE__BTREE_H
+#define LITE__BTREE_H
+
+#include <lace/do_not_copy.h>
+#include "link.h"
+#include "order.h"
+
+#include <lace/compare.h>
+
+#include <cassert>
+#include <cstddef>
+#include <stdint.h>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace lite {
+
+template <class X>
+class btree_link {
+public:
+  typedef btree_link type;
+  template <class T, typename btree_link<T>::type T::*L,
+            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &),
+            unsigned N>
+    friend class btree;
+
+  bool bound() const { return leaf.p; }
+
+private:
+  link<void> leaf;
+};
+
+// positions of k among n sorted integers, without a comparator call per
+// probe: a branchless binary search, whose steps compile to conditional moves
+template <typename K>
+struct btree_count {
+  // the number of keys less than k
+  static unsigned less(const K* keys, unsigned n, K k) {
+    if (!n)
+      return 0;
+    const K* base = keys;
+    while (n > 1) {
+      unsigned half = n / 2;
+      base = base[half] < k ? base + half : base;
+      n -= half;
+    }
+    return (base - keys) + (*base < k);
+  }
+
+  // the number of keys no greater than k
+  static unsigned most(const K* keys, unsigned n, K k) {
+    if (!n)
+      return 0;
+    const K* base = keys;
+    while (n > 1) {
+      unsigned half = n / 2;
+      base = k < base[half] ? base : base + half;
+      n -= half;
+    }
+    return (base - keys) + !(k < *base);
+  }
+};
+
+#if defined(__SSE2__)
+// 32-bit keys compare four or eight at a time, stopping at the first
+// vector that is not wholly below k; unsigned keys are biased into the
+// signed range, which is all the vector compares offer
+template <typename K>
+struct btree_count_32 {
+  static const uint32_t bias = std::is_signed<K>::value ? 0 : 0x80000000u;
+
+  static unsigned less(const K* keys, unsigned n, K k) {
+    unsigned i = 0;
+#if defined(__AVX2__)
+    const __m256i k8 = _mm256_set1_epi32(int32_t(uint32_t(k) ^ bias));
+    const __m256i b8 = _mm256_set1_epi32(int32_t(bias));
+    for ( ; i + 8 <= n ; i += 8) {
+      __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + i)), b8);
+      unsigned m = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k8, x)));
+      if (m != 0xff)
+        return i + __builtin_ctz(~m);
+    }
+#endif
+    const __m128i k4 = _mm_set1_epi32(int32_t(uint32_t(k) ^ bias));
+    const __m128i b4 = _mm_set1_epi32(int32_t(bias));
+    for ( ; i + 4 <= n ; i += 4) {
+      __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(keys + i)), b4);
+      unsigned m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k4, x)));
+      if (m != 0xf)
+        return i + __builtin_ctz(~m);
+    }
+    while (i < n && keys[i] < k)
+      ++i;
+    return i;
+  }
+
+  static unsigned most(const K* keys, unsigned n, K k) {
+    unsigned i = 0;
+#if defined(__AVX2__)
+    const __m256i k8 = _mm256_set1_epi32(int32_t(uint32_t(k) ^ bias));
+    const __m256i b8 = _mm256_set1_epi32(int32_t(bias));
+    for ( ; i + 8 <= n ; i += 8) {
+      __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + i)), b8);
+      unsigned m = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, k8)));
+      if (m)
+        return i + __builtin_ctz(m);
+    }
+#endif
+    const __m128i k4 = _mm_set1_epi32(int32_t(uint32_t(k) ^ bias));
+    const __m128i b4 = _mm_set1_epi32(int32_t(bias));
+    for ( ; i + 4 <= n ; i += 4) {
+      __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(keys + i)), b4);
+      unsigned m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, k4)));
+      if (m)
+        return i + __builtin_ctz(m);
+    }
+    while (i < n && !(k < keys[i]))
+      ++i;
+    return i;
+  }
+};
+
+template <> struct btree_count<int32_t> : btree_count_32<int32_t> { };
+template <> struct btree_count<uint32_t> : btree_count_32<uint32_t> { };
+#endif//__SSE2__
+
+// locates k among a node's n sorted keys by binary search with C; lower
+// finds the first key not ordered before k, upper the first ordered after
+template <typename K, lace::compare_t (*C)(K const &, K const &),
+          bool = std::is_integral<K>::value>
+struct btree_scan {
+  static unsigned lower(const K* keys, unsigned n, const K & k) {
+    unsigned lo = 0, hi = n;
+    while (lo < hi) {
+      unsigned mid = (lo + hi) / 2;
+      if (C(keys[mid], k) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  static unsigned upper(const K* keys, unsigned n, const K & k) {
+    unsigned lo = 0, hi = n;
+    while (lo < hi) {
+      unsigned mid = (lo + hi) / 2;
+      if (C(k, keys[mid]) < 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return lo;
+  }
+};
+
+// integer keys in ascending order are counted by btree_count instead; any
+// other comparator still gets the binary search
+template <typename K, lace::compare_t (*C)(K const &, K const &)>
+struct btree_scan<K, C, true> {
+  typedef btree_scan<K, C, false> search_t;
+
+  static unsigned lower(const K* keys, unsigned n, const K & k) {
+    return order<K, C>::forward()
+      ? btree_count<K>::less(keys, n, k)
+      : search_t::lower(keys, n, k);
+  }
+
+  static unsigned upper(const K* keys, unsigned n, const K & k) {
+    return order<K, C>::forward()
+      ? btree_count<K>::most(keys, n, k)
+      : search_t::upper(keys, n, k);
+  }
+};
+
+// B+ tree ordering intrusive nodes by a copy of their keys, so that a
+// search touches a few wide nodes rather than one node per comparison;
+// each link names only its leaf, so that shifting items within a leaf
+// writes the leaf alone, & a link is rewritten only when its item moves
+// to another leaf; next, prev & prune find the slot by searching that leaf
+template <class T, typename btree_link<T>::type T::*L,
+          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &) = lace::compare<K>,
+          unsigned N = (256 / sizeof(K) < 8 ? 8 : 256 / sizeof(K))>
+class btree : public lace::do_not_copy {
+  static_assert(N >= 4, "btree nodes need room to split");
+
+public:
+  static const unsigned order = N;
+
+  btree() : root_(NULL), size_(0) { }
+  ~btree() { assert(empty()); }
+
+  bool empty() const { return !size_; }
+  size_t size() const { return size_; }
+
+  static
+  lace::compare_t compare(const T* foo, const T* bar) {
+    return C(foo->*key, bar->*key);
+  }
+
+  // equal keys are kept in the order they were grafted
+  btree & graft(T* t) {
+    assert(valid());
+    assert(!is_bound(t));
+
+    if (!root_)
+      root_ = new leaf_t;
+
+    const K & k = t->*key;
+    node_t* n = root_;
+    while (!n->leaf) {
+      inner_t* i = static_cast<inner_t*>(n);
+      n = i->children[upper(i->keys, i->count, k)];
+    }
+
+    leaf_t* l = static_cast<leaf_t*>(n);
+    unsigned s = upper(l->keys, l->count, k);
+    for (unsigned j = l->count ; j > s ; --j)
+      shift(l, j, j - 1);
+    place(l, s, t);
+
+    if (++l->count > N)
+      split(l);
+    ++size_;
+
+    assert(is_member(t));
+    assert(valid());
+
+    return *this;
+  }
+
+  T* prune(T* t) {
+    assert(valid());
+    assert(is_member(t));
+
+    leaf_t* l = leaf_of(t);
+    for (unsigned j = slot_of(t) + 1 ; j < l->count ; ++j)
+      shift(l, j - 1, j);
+    --l->count;
+
+    unlink(t);
+    --size_;
+    rebalance(l);
+
+    assert(!is_bound(t));
+    assert(valid());
+
+    return t;
+  }
+
+  typedef void (T::*axe_t)();
+
+  btree & fell(const axe_t a = NULL) {
+    for (leaf_t* l = leftest() ; l ; l = l->next) {
+      for (unsigned j = 0 ; j < l->count ; ++j) {
+        T* t = l->items[j];
+        unlink(t);
+        if (a)
+          (t->*a)();
+      }
+    }
+
+    return forget();
+  }
+
+  void swap(btree & that) {
+    using std::swap;
+    swap(this->root_, that.root_);
+    swap(this->size_, that.size_);
+  }
+
+  bool is_member(const T* n) const {
+    assert(n);
+    return is_bound(n) && eldest(leaf_of(n)) == root_;
+  }
+
+  T* min() const {
+    const leaf_t* l = leftest();
+    return l ? l->items[0] : NULL;
+  }
+
+  T* max() const {
+    const leaf_t* l = rightest();
+    return l ? l->items[l->count - 1] : NULL;
+  }
+
+  T* next(const T* n) const {
+    assert(is_member(n));
+
+    const leaf_t* l = leaf_of(n);
+    unsigned s = slot_of(n) + 1;
+    if (s < l->count)
+      return l->items[s];
+
+    return l->next ? l->next->items[0] : NULL;
+  }
+
+  T* prev(const T* n) const {
+    assert(is_member(n));
+
+    const leaf_t* l = leaf_of(n);
+    unsigned s = slot_of(n);
+    if (s > 0)
+      return l->items[s - 1];
+
+    return l->prev ? l->prev->items[l->prev->count - 1] : NULL;
+  }
+
+  // the first node grafted with key k
+  T* find(const K & k) const {
+    if (!root_)
+      return NULL;
+
+    const node_t* n = root_;
+    while (!n->leaf) {
+      const inner_t* i = static_cast<const inner_t*>(n);
+      n = i->children[lower(i->keys, i->count, k)];
+    }
+
+    // keys equal to k may begin with the next leaf
+    const leaf_t* l = static_cast<const leaf_t*>(n);
+    unsigned s = lower(l->keys, l->count, k);
+    if (s == l->count) {
+      if (!(l = l->next))
+        return NULL;
+      s = 0;
+    }
+
+    return 0 == C(k, l->keys[s]) ? l->items[s] : NULL;
+  }
+
+  // frees the inner nodes & leaves, leaving the nodes' links stale
+  btree & forget() {
+    if (root_)
+      destroy(root_);
+    root_ = NULL;
+    size_ = 0;
+    return *this;
+  }
+
+private:
+  struct inner_t;
+
+  struct node_t {
+    node_t(bool l) : parent(NULL), count(0), leaf(l) { }
+
+    inner_t* parent;
+    unsigned count;
+    bool leaf;
+  };
+
+  // count keys, each copied from the node beside it, plus a spare slot
+  // that holds an insertion until the leaf splits
+  struct leaf_t : node_t {
+    leaf_t() : node_t(true), prev(NULL), next(NULL) { }
+
+    leaf_t *prev, *next;
+    K keys[N + 1];
+    T* items[N + 1];
+  };
+
+  // count separators between count + 1 children; nothing under children[i]
+  // orders after keys[i], nor anything under children[i + 1] before it
+  struct inner_t : node_t {
+    inner_t() : node_t(false) { }
+
+    K keys[N + 1];
+    node_t* children[N + 2];
+  };
+
+  node_t * root_;
+  size_t size_;
+
+  static bool is_bound(const T* n) { assert(n); return (n->*L).bound(); }
+
+  static leaf_t* leaf_of(const T* n) { return static_cast<leaf_t*>((n->*L).leaf.p); }
+
+  // the first copy of n's key in its leaf, then n among any equal keys
+  static unsigned slot_of(const T* n) {
+    const leaf_t* l = leaf_of(n);
+    unsigned s = lower(l->keys, l->count, n->*key);
+    while (l->items[s] != n) {
+      ++s;
+      assert(s < l->count);
+    }
+    return s;
+  }
+
+  static unsigned lower(const K* keys, unsigned n, const K & k) {
+    return btree_scan<K, C>::lower(keys, n, k);
+  }
+
+  static unsigned upper(const K* keys, unsigned n, const K & k) {
+    return btree_scan<K, C>::upper(keys, n, k);
+  }
+
+  static const node_t* eldest(const node_t* n) {
+    assert(n);
+    while (const node_t* p = n->parent)
+      n = p;
+    return n;
+  }
+
+  leaf_t* leftest() const {
+    node_t* n = root_;
+    if (!n)
+      return NULL;
+    while (!n->leaf)
+      n = static_cast<inner_t*>(n)->children[0];
+    return static_cast<leaf_t*>(n);
+  }
+
+  leaf_t* rightest() const {
+    node_t* n = root_;
+    if (!n)
+      return NULL;
+    while (!n->leaf)
+      n = static_cast<inner_t*>(n)->children[n->count];
+    return static_cast<leaf_t*>(n);
+  }
+
+  static unsigned index(const inner_t* p, const node_t* c) {
+    unsigned s = 0;
+    while (p->children[s] != c)
+      ++s;
+    assert(s <= p->count);
+    return s;
+  }
+
+  static void place(leaf_t* l, unsigned s, T* t) {
+    l->keys[s] = t->*key;
+    l->items[s] = t;
+    (t->*L).leaf.p = l;
+  }
+
+  // moves an item within its leaf, leaving the item itself untouched
+  static void shift(leaf_t* l, unsigned to, unsigned from) {
+    l->keys[to] = l->keys[from];
+    l->items[to] = l->items[from];
+  }
+
+  static void unlink(T* t) { (t->*L).leaf.p = NULL; }
+
+  static void destroy(node_t* n) {
+    if (n->leaf) {
+      delete static_cast<leaf_t*>(n);
+      return;
+    }
+
+    inner_t* i = static_cast<inner_t*>(n);
+    for (unsigned j = 0 ; j <= i->count ; ++j)
+      destroy(i->children[j]);
+    delete i;
+  }
+
+  // links r into the parent of l, just after it, separated by k
+  void adopt(node_t* l, const K & k, node_t* r) {
+    inner_t* p = l->parent;
+    if (!p) {
+      p = new inner_t;
+      p->children[0] = l;
+      l->parent = p;
+      root_ = p;
+    }
+
+    unsigned s = index(p, l);
+    for (unsigned j = p->count ; j > s ; --j) {
+      p->keys[j] = p->keys[j - 1];
+      p->children[j + 1] = p->children[j];
+    }
+    p->keys[s] = k;
+    p->children[s + 1] = r;
+    r->parent = p;
+
+    if (++p->count > N)
+      split(p);
+  }
+
+  void split(leaf_t* l) {
+    assert(l->count == N + 1);
+
+    leaf_t* r = new leaf_t;
+    const unsigned h = l->count / 2;
+    for (unsigned j = h ; j < l->count ; ++j)
+      place(r, j - h, l->items[j]);
+    r->count = l->count - h;
+    l->count = h;
+
+    r->next = l->next;
+    if (r->next)
+      r->next->prev = r;
+    r->prev = l;
+    l->next = r;
+
+    adopt(l, r->keys[0], r);
+  }
+
+  // the middle separator moves up rather than being copied
+  void split(inner_t* l) {
+    assert(l->count == N + 1);
+
+    inner_t* r = new inner_t;
+    const unsigned h = l->count / 2;
+    r->count = l->count - h - 1;
+    for (unsigned j = 0 ; j < r->count ; ++j)
+      r->keys[j] = l->keys[h + 1 + j];
+    for (unsigned j = 0 ; j <= r->count ; ++j) {
+      r->children[j] = l->children[h + 1 + j];
+      r->children[j]->parent = r;
+    }
+    l->count = h;
+
+    adopt(l, l->keys[h], r);
+  }
+
+  // drops separator s of p & the child to its right
+  void remove(inner_t* p, unsigned s) {
+    for (unsigned j = s + 1 ; j < p->count ; ++j) {
+      p->keys[j - 1] = p->keys[j];
+      p->children[j] = p->children[j + 1];
+    }
+    --p->count;
+
+    rebalance(p);
+  }
+
+  // l absorbs r, its right neighbour under separator s
+  void merge(leaf_t* l, leaf_t* r, unsigned s) {
+    for (unsigned j = 0 ; j < r->count ; ++j)
+      place(l, l->count + j, r->items[j]);
+    l->count += r->count;
+
+    l->next = r->next;
+    if (l->next)
+      l->next->prev = l;
+    delete r;
+
+    remove(l->parent, s);
+  }
+
+  void merge(inner_t* l, inner_t* r, unsigned s) {
+    inner_t* p = l->parent;
+
+    l->keys[l->count] = p->keys[s];
+    for (unsigned j = 0 ; j < r->count ; ++j)
+      l->keys[l->count + 1 + j] = r->keys[j];
+    for (unsigned j = 0 ; j <= r->count ; ++j) {
+      l->children[l->count + 1 + j] = r->children[j];
+      r->children[j]->parent = l;
+    }
+    l->count += r->count + 1;
+    delete r;
+
+    remove(p, s);
+  }
+
+  // refills a leaf left less than half full from a neighbour, or merges
+  void rebalance(leaf_t* l) {
+    inner_t* p = l->parent;
+    if (!p) {
+      if (!l->count) {
+        delete l;
+        root_ = NULL;
+      }
+      return;
+    }
+
+    if (l->count >= N / 2)
+      return;
+
+    unsigned s = index(p, l);
+    leaf_t* left = s > 0 ? static_cast<leaf_t*>(p->children[s - 1]) : NULL;
+    leaf_t* right = s < p->count ? static_cast<leaf_t*>(p->children[s + 1]) : NULL;
+
+    if (left && left->count > N / 2) {
+      for (unsigned j = l->count ; j > 0 ; --j)
+        shift(l, j, j - 1);
+      place(l, 0, left->items[--left->count]);
+      ++l->count;
+      p->keys[s - 1] = l->keys[0];
+    } else if (right && right->count > N / 2) {
+      place(l, l->count++, right->items[0]);
+      for (unsigned j = 1 ; j < right->count ; ++j)
+        shift(right, j - 1, j);
+      --right->count;
+      p->keys[s] = right->keys[0];
+    } else if (left) {
+      merge(left, l, s - 1);
+    } else {
+      assert(right);
+      merge(l, right, s);
+    }
+  }
+
+  // as for leaves, but borrowing rotates a child through the parent
+  void rebalance(inner_t* n) {
+    inner_t* p = n->parent;
+    if (!p) {
+      if (!n->count) {
+        root_ = n->children[0];
+        root_->parent = NULL;
+        delete n;
+      }
+      return;
+    }
+
+    if (n->count >= N / 2)
+      return;
+
+    unsigned s = index(p, n);
+    inner_t* left = s > 0 ? static_cast<inner_t*>(p->children[s - 1]) : NULL;
+    inner_t* right = s < p->count ? static_cast<inner_t*>(p->children[s + 1]) : NULL;
+
+    if (left && left->count > N / 2) {
+      for (unsigned j = n->count ; j > 0 ; --j)
+        n->keys[j] = n->keys[j - 1];
+      for (unsigned j = n->count + 1 ; j > 0 ; --j)
+        n->children[j] = n->children[j - 1];
+      n->keys[0] = p->keys[s - 1];
+      n->children[0] = left->children[left->count];
+      n->children[0]->parent = n;
+      ++n->count;
+
+      p->keys[s - 1] = left->keys[--left->count];
+    } else if (right && right->count > N / 2) {
+      n->keys[n->count] = p->keys[s];
+      n->children[n->count + 1] = right->children[0];
+      n->children[n->count + 1]->parent = n;
+      ++n->count;
+
+      p->keys[s] = right->keys[0];
+      for (unsigned j = 1 ; j < right->count ; ++j)
+        right->keys[j - 1] = right->keys[j];
+      for (unsigned j = 1 ; j <= right->count ; ++j)
+        right->children[j - 1] = right->children[j];
+      --right->count;
+    } else if (left) {
+      merge(left, n, s - 1);
+    } else {
+      assert(right);
+      merge(n, right, s);
+    }
+  }
+
+#ifndef NDEBUG
+  // checks occupancy, parentage, links & order, with lo & hi bounding the
+  // keys under n; returns the depth of its leaves, or 0 if invalid
+  size_t valid(const node_t* n, const K* lo, const K* hi) const {
+    if (n->count > N || (n != root_ && n->count < N / 2))
+      return 0;
+
+    if (n->leaf) {
+      const leaf_t* l = static_cast<const leaf_t*>(n);
+      for (unsigned j = 0 ; j < l->count ; ++j) {
+        const T* t = l->items[j];
+        if (leaf_of(t) != l || 0 != C(l->keys[j], t->*key) || slot_of(t) != j)
+          return 0;
+        if (j && C(l->keys[j], l->keys[j - 1]) < 0)
+          return 0;
+        if ((lo && C(l->keys[j], *lo) < 0) || (hi && C(*hi, l->keys[j]) < 0))
+          return 0;
+      }
+      return 1;
+    }
+
+    const inner_t* i = static_cast<const inner_t*>(n);
+    size_t depth = 0;
+    for (unsigned j = 0 ; j <= i->count ; ++j) {
+      if (i->children[j]->parent != i)
+        return 0;
+      size_t d = valid(i->children[j], j ? &i->keys[j - 1] : lo, j < i->count ? &i->keys[j] : hi);
+      if (!d || (depth && d != depth))
+        return 0;
+      depth = d;
+    }
+    return depth + 1;
+  }
+
+  bool valid() const {
+    if (!root_)
+      return !size_;
+    return !root_->parent && valid(root_, NULL, NULL);
+  }
+#endif//!NDEBUG
+
+};
+
+} // namespace lite
+
+#endif//LITE__BTREE_H
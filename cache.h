@@ -0,0 +1,336 @@
+#ifndef LITE__CACHE_H
+#define LITE__CACHE_H
+
+#include <lace/do_not_copy.h>
+#include "list.h"
+#include "table.h"
+
+#include <lace/hash.h>
+#include <lace/compare.h>
+
+#include <cassert>
+#include <cstddef>
+
+namespace lite {
+
+// the per-node state of clock_cache & slru_cache, which both keep a
+// reference bit, & slru_cache also the segment holding the node
+template <class X>
+class cache_mark {
+public:
+  typedef cache_mark type;
+  template <class T, typename table_link<T>::type T::*I,
+            typename list_link<T>::type T::*R, typename cache_mark<T>::type T::*M,
+            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &),
+            lace::hash_t (*H)(K const &)>
+    friend class clock_cache;
+  template <class T, typename table_link<T>::type T::*I,
+            typename list_link<T>::type T::*R, typename cache_mark<T>::type T::*M,
+            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &),
+            lace::hash_t (*H)(K const &)>
+    friend class slru_cache;
+
+  cache_mark() : bits(0) { }
+
+private:
+  enum { referenced = 1, shielded = 2 };
+  unsigned char bits;
+};
+
+// the hash index & bookkeeping shared by the caches below, each of which
+// adds an order in which to evict; the index is sized to the capacity, so
+// chains stay short without rehashing
+template <class T, typename table_link<T>::type T::*I,
+          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &),
+          lace::hash_t (*H)(K const &)>
+class cache_index : public lace::do_not_copy {
+public:
+  // called on each node the cache evicts, after it has been unlinked
+  typedef void (T::*evictor_t)();
+
+  cache_index(size_t capacity, const evictor_t e)
+    : capacity_(capacity), size_(0), evictor_(e)
+  { assert(capacity_ > 0); index_.reseat(capacity_); }
+
+  ~cache_index() { assert(empty()); index_.reseat(0); }
+
+  bool empty() const { return !size_; }
+  bool full() const { return size_ == capacity_; }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+  // looks k up without counting it as a use
+  T* peek(const K & k) const { return index_.find(k); }
+
+  bool is_member(const T* t) const { return index_.is_member(t); }
+
+protected:
+  void admit(T* t) {
+    assert(!full());
+    assert(!peek(t->*key));
+    index_.set(t);
+    ++size_;
+  }
+
+  T* expel(T* t) {
+    assert(size_ > 0);
+    index_.bus(t);
+    --size_;
+    return t;
+  }
+
+  void evicted(T* t) const {
+    if (evictor_)
+      (t->*evictor_)();
+  }
+
+  table<T, I, K, key, C, H> index_;
+
+private:
+  const size_t capacity_;
+  size_t size_;
+  const evictor_t evictor_;
+};
+
+// least recently used: a hit relinks its node at the back of the recency
+// list, & the node at the front is evicted to make room for a new one
+template <class T, typename table_link<T>::type T::*I,
+          typename list_link<T>::type T::*R,
+          typename K, K T::*key,
+          lace::compare_t (*C)(K const &, K const &) = lace::compare<K>,
+          lace::hash_t (*H)(K const &) = lace::hash<K> >
+class lru_cache : public cache_index<T, I, K, key, C, H> {
+public:
+  typedef cache_index<T, I, K, key, C, H> index_t;
+  typedef typename index_t::evictor_t evictor_t;
+
+  lru_cache(size_t capacity, const evictor_t e = NULL) : index_t(capacity, e) { }
+
+  T* get(const K & k) {
+    T* t = this->index_.get(k);
+    if (t && t != recency_.last()) {
+      recency_.delist(t);
+      recency_.enlist(t);
+    }
+    return t;
+  }
+
+  lru_cache & put(T* t) {
+    if (this->full())
+      evict(recency_.first());
+
+    this->admit(t);
+    recency_.enlist(t);
+    return *this;
+  }
+
+  T* erase(T* t) {
+    recency_.delist(t);
+    return this->expel(t);
+  }
+
+  typedef void (T::*axe_t)();
+
+  lru_cache & fell(const axe_t a = NULL) {
+    while (T* t = recency_.first()) {
+      erase(t);
+      if (a)
+        (t->*a)();
+    }
+
+    assert(this->empty());
+    return *this;
+  }
+
+private:
+  list<T, R> recency_;
+
+  void evict(T* t) { this->evicted(erase(t)); }
+};
+
+// CLOCK, which approximates LRU without relinking on a hit: a hit only
+// sets its node's reference bit, & to make room the hand sweeps the ring,
+// clearing bits as it passes, until it finds a node whose bit is clear
+template <class T, typename table_link<T>::type T::*I,
+          typename list_link<T>::type T::*R, typename cache_mark<T>::type T::*M,
+          typename K, K T::*key,
+          lace::compare_t (*C)(K const &, K const &) = lace::compare<K>,
+          lace::hash_t (*H)(K const &) = lace::hash<K> >
+class clock_cache : public cache_index<T, I, K, key, C, H> {
+public:
+  typedef cache_index<T, I, K, key, C, H> index_t;
+  typedef typename index_t::evictor_t evictor_t;
+  typedef cache_mark<T> mark_t;
+
+  clock_cache(size_t capacity, const evictor_t e = NULL) : index_t(capacity, e) { }
+
+  // the index is searched without reordering its chain, & the bit tested
+  // before it is set, so that hits on a node already referenced write nothing
+  T* get(const K & k) {
+    T* t = this->index_.find(k);
+    if (t && !((t->*M).bits & mark_t::referenced))
+      (t->*M).bits |= mark_t::referenced;
+    return t;
+  }
+
+  // new nodes go just behind the hand, so they are the last it reaches
+  clock_cache & put(T* t) {
+    if (this->full())
+      evict(sweep());
+
+    (t->*M).bits = 0;
+    this->admit(t);
+    ring_.enlist(t);
+    return *this;
+  }
+
+  T* erase(T* t) {
+    ring_.delist(t);
+    (t->*M).bits = 0;
+    return this->expel(t);
+  }
+
+  typedef void (T::*axe_t)();
+
+  clock_cache & fell(const axe_t a = NULL) {
+    while (T* t = ring_.first()) {
+      erase(t);
+      if (a)
+        (t->*a)();
+    }
+
+    assert(this->empty());
+    return *this;
+  }
+
+private:
+  list<T, R> ring_;
+
+  // the hand is the head of the ring, so it stops at most one lap on
+  T* sweep() {
+    T* t = ring_.first();
+    while ((t->*M).bits & mark_t::referenced) {
+      (t->*M).bits &= ~mark_t::referenced;
+      t = ring_.prograde();
+    }
+    return t;
+  }
+
+  void evict(T* t) { this->evicted(erase(t)); }
+};
+
+// segmented LRU: nodes enter a probationary segment, & are promoted to a
+// protected one, of four fifths the capacity, when hit there; so a burst
+// of keys used once evicts only other probationary nodes.  Within the
+// protected segment a hit just sets a reference bit, as in clock_cache,
+// & overflow is demoted to probation by the same sweep; so a node is
+// relinked only as it moves between segments, never on a repeated hit,
+// & the index's chains are likewise left in order
+template <class T, typename table_link<T>::type T::*I,
+          typename list_link<T>::type T::*R, typename cache_mark<T>::type T::*M,
+          typename K, K T::*key,
+          lace::compare_t (*C)(K const &, K const &) = lace::compare<K>,
+          lace::hash_t (*H)(K const &) = lace::hash<K> >
+class slru_cache : public cache_index<T, I, K, key, C, H> {
+public:
+  typedef cache_index<T, I, K, key, C, H> index_t;
+  typedef typename index_t::evictor_t evictor_t;
+  typedef cache_mark<T> mark_t;
+
+  slru_cache(size_t capacity, const evictor_t e = NULL)
+    : index_t(capacity, e)
+    , shield_(capacity - capacity / 5)
+    , shielded_(0)
+  { assert(shield_ > 0); }
+
+  T* get(const K & k) {
+    T* t = this->index_.find(k);
+    if (!t)
+      return NULL;
+
+    if (!((t->*M).bits & mark_t::shielded))
+      promote(t);
+    else if (!((t->*M).bits & mark_t::referenced))
+      (t->*M).bits |= mark_t::referenced;
+
+    return t;
+  }
+
+  slru_cache & put(T* t) {
+    if (this->full())
+      evict(probation_.empty() ? sweep() : probation_.first());
+
+    (t->*M).bits = 0;
+    this->admit(t);
+    probation_.enlist(t);
+    return *this;
+  }
+
+  T* erase(T* t) {
+    if ((t->*M).bits & mark_t::shielded) {
+      protected_.delist(t);
+      --shielded_;
+    } else {
+      probation_.delist(t);
+    }
+
+    (t->*M).bits = 0;
+    return this->expel(t);
+  }
+
+  // the number of nodes in the protected segment
+  size_t shielded() const { return shielded_; }
+
+  typedef void (T::*axe_t)();
+
+  slru_cache & fell(const axe_t a = NULL) {
+    while (T* t = probation_.first() ? probation_.first() : protected_.first()) {
+      erase(t);
+      if (a)
+        (t->*a)();
+    }
+
+    assert(this->empty());
+    return *this;
+  }
+
+private:
+  const size_t shield_;
+  size_t shielded_;
+  list<T, R> probation_;
+  list<T, R> protected_;
+
+  void promote(T* t) {
+    probation_.delist(t);
+    if (shielded_ == shield_)
+      demote(sweep());
+
+    protected_.enlist(t);
+    (t->*M).bits = mark_t::shielded;
+    ++shielded_;
+  }
+
+  // a demoted node goes to the back of probation, as if newly put
+  void demote(T* t) {
+    protected_.delist(t);
+    --shielded_;
+    (t->*M).bits = 0;
+    probation_.enlist(t);
+  }
+
+  T* sweep() {
+    T* t = protected_.first();
+    while ((t->*M).bits & mark_t::referenced) {
+      (t->*M).bits &= ~mark_t::referenced;
+      t = protected_.prograde();
+    }
+    return t;
+  }
+
+  void evict(T* t) { this->evicted(erase(t)); }
+};
+
+} // namespace lite
+
+#endif//LITE__CACHE_H
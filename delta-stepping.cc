@@ -0,0 +1,314 @@
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <algorithm>
+
+#include <unistd.h>
+
+#include <lace/compare.h>
+#include "graph.h"
+#include "list.h"
+#include "pool.h"
+#include "symbol.h"
+#include "table.h"
+#include "tokenizer.h"
+
+typedef lite::graph<unsigned> graph_t;
+
+struct vertex_t {
+  vertex_t(const lite::symbol & c, graph_t::index_t i)
+    : id(c)
+    , slot(i)
+    , route(NULL)
+    , phase(0)
+  { }
+
+  lite::symbol id;
+  graph_t::index_t slot;
+  unsigned cost;
+  vertex_t* route;
+  unsigned phase;
+
+  lite::table_link<vertex_t> v_link;
+  typedef lite::table<vertex_t, &vertex_t::v_link, typeof(vertex_t::id), &vertex_t::id,
+                      lite::symbol::compare, lite::symbol::hash> vertices_t;
+
+  lite::list_link<vertex_t> b_link;
+  typedef lite::list<vertex_t, &vertex_t::b_link> bucket_t;
+
+  bool
+  bound() const {
+    return false
+        || v_link.bound()
+        || b_link.bound()
+        ;;
+  }
+};
+
+struct request_t {
+  vertex_t* to;
+  vertex_t* from;
+  unsigned cost;
+};
+
+static const unsigned most = 64;
+// phases with less work than this run on the calling thread alone
+static size_t grain = 1 << 10;
+
+static unsigned threads = 1;
+static unsigned delta = 1;
+
+static graph_t graph;
+static std::vector<vertex_t*> slots;
+
+// each worker owns the vertices whose slot falls to it, along with their
+// buckets, so relaxations never contend; requests for a vertex are routed
+// to its owner's outbox, one per sending worker
+struct worker_t {
+  vertex_t::bucket_t* buckets;
+  unsigned n_buckets;
+  size_t pending;
+
+  std::vector<vertex_t*> frontier;
+  std::vector<vertex_t*> settled;
+  std::vector<request_t> outbox[most];
+
+  worker_t() : buckets(NULL), n_buckets(0), pending(0) { }
+  ~worker_t() { delete [] buckets; }
+
+  vertex_t::bucket_t & bucket(unsigned cost) { return buckets[cost / delta % n_buckets]; }
+
+  void relax(const request_t & r) {
+    vertex_t* v = r.to;
+    if (v->route && r.cost >= v->cost)
+      return;
+
+    if (v->b_link.bound()) {
+      bucket(v->cost).delist(v);
+      --pending;
+    }
+
+    v->cost = r.cost;
+    v->route = r.from;
+
+    bucket(v->cost).enlist(v);
+    ++pending;
+  }
+
+  // empties bucket i into the frontier, noting each vertex as settled in
+  // phase i the first time it is seen there
+  size_t take(unsigned i) {
+    frontier.clear();
+
+    vertex_t::bucket_t & b = buckets[i % n_buckets];
+    while (vertex_t* v = b.first()) {
+      b.delist(v);
+      --pending;
+
+      frontier.push_back(v);
+      if (v->phase != i + 1) {
+        v->phase = i + 1;
+        settled.push_back(v);
+      }
+    }
+
+    return frontier.size();
+  }
+};
+
+static worker_t workers[most];
+
+static inline unsigned owner(graph_t::index_t slot) { return slot % threads; }
+
+// arcs are sorted by cost, so the light ones form a prefix
+void
+request(unsigned t, bool light) {
+  worker_t & w = workers[t];
+  const std::vector<vertex_t*> & from = light ? w.frontier : w.settled;
+
+  for (size_t i = 0 ; i < from.size() ; ++i) {
+    vertex_t* v = from[i];
+    for (const graph_t::arc_t* a = graph.begin(v->slot) ; a != graph.end(v->slot) ; ++a) {
+      if (light != (a->cost <= delta)) {
+        if (light)
+          break;
+        continue;
+      }
+
+      if (a->to == v->slot)
+        continue;
+
+      request_t r = { slots[a->to], v, v->cost + a->cost };
+      w.outbox[owner(a->to)].push_back(r);
+    }
+  }
+}
+
+void
+apply(unsigned t) {
+  for (unsigned s = 0 ; s < threads ; ++s) {
+    std::vector<request_t> & in = workers[s].outbox[t];
+    for (size_t i = 0 ; i < in.size() ; ++i)
+      workers[t].relax(in[i]);
+    in.clear();
+  }
+}
+
+template <typename F, typename... A>
+void
+run(size_t work, F f, A... a) {
+  if (threads > 1 && work >= grain) {
+    std::thread ts[most];
+    for (unsigned t = 0 ; t < threads ; ++t)
+      ts[t] = std::thread(f, t, a...);
+    for (unsigned t = 0 ; t < threads ; ++t)
+      ts[t].join();
+  } else {
+    for (unsigned t = 0 ; t < threads ; ++t)
+      f(t, a...);
+  }
+}
+
+size_t
+pending() {
+  size_t n = 0;
+  for (unsigned t = 0 ; t < threads ; ++t)
+    n += workers[t].pending;
+  return n;
+}
+
+void
+delta_stepping(vertex_t* s, unsigned max_cost) {
+  const unsigned n_buckets = max_cost / delta + 2;
+  for (unsigned t = 0 ; t < threads ; ++t) {
+    workers[t].buckets = new vertex_t::bucket_t[n_buckets];
+    workers[t].n_buckets = n_buckets;
+  }
+
+  request_t r = { s, s, 0 };
+  workers[owner(s->slot)].relax(r);
+
+  for (unsigned i = 0 ; pending() ; ++i) {
+    bool empty = true;
+    for (unsigned t = 0 ; t < threads ; ++t)
+      empty &= workers[t].buckets[i % n_buckets].empty();
+    if (empty)
+      continue;
+
+    for (unsigned t = 0 ; t < threads ; ++t)
+      workers[t].settled.clear();
+
+    // light arcs may refill bucket i, so repeat until it stays empty
+    for (;;) {
+      size_t taken = 0;
+      for (unsigned t = 0 ; t < threads ; ++t)
+        taken += workers[t].take(i);
+      if (!taken)
+        break;
+
+      run(taken, request, true);
+      run(taken, apply);
+    }
+
+    size_t settled = 0;
+    for (unsigned t = 0 ; t < threads ; ++t)
+      settled += workers[t].settled.size();
+
+    run(settled, request, false);
+    run(settled, apply);
+  }
+}
+
+int
+main(int argc, char* argv[]) {
+  const unsigned load = 2;
+  unsigned n_vertices = 0;
+  lite::pool<vertex_t> vertex_pool;
+  lite::tokenizer input;
+  vertex_t::vertices_t vertices;
+  std::vector<graph_t::edge_t> edges;
+
+  threads = argc > 1 ? strtoul(argv[1], NULL, 0) : std::thread::hardware_concurrency();
+  threads = std::max(1u, std::min(most, threads));
+
+  vertex_t* s = NULL;
+  unsigned max_cost = 0;
+  unsigned long long total_cost = 0;
+
+  while (input.line()) {
+    const char* token = input.token();
+    if (!token || '#' == *token)
+      continue;
+    const lite::symbol from(token);
+
+    if (!(token = input.token()))
+      continue;
+    const lite::symbol to(token);
+
+    token = input.token();
+    unsigned cost = token ? strtoul(token, NULL, 10) : 1;
+
+    vertex_t* f = vertices.get(from);
+    if (!f) {
+      ++n_vertices;
+      if (vertices.buckets() < load * n_vertices)
+        vertices.reseat((load+1) * (n_vertices+1));
+      vertices.set(f = new (vertex_pool.allocate()) vertex_t(from, slots.size()));
+      slots.push_back(f);
+    }
+    if (!s || lace::compare(f->id.text, s->id.text) < 0)
+      s = f;
+
+    vertex_t* t = vertices.get(to);
+    if (!t) {
+      ++n_vertices;
+      if (vertices.buckets() < load * n_vertices)
+        vertices.reseat((load+1) * (n_vertices+1));
+      vertices.set(t = new (vertex_pool.allocate()) vertex_t(to, slots.size()));
+      slots.push_back(t);
+    }
+    if (!s || lace::compare(t->id.text, s->id.text) < 0)
+      s = t;
+
+    max_cost = std::max(max_cost, cost);
+    total_cost += cost;
+
+    graph_t::edge_t e = { f->slot, t->slot, cost };
+    edges.push_back(e);
+  }
+
+  // by default, a bucket spans the mean arc cost
+  delta = argc > 2 ? strtoul(argv[2], NULL, 0)
+        : edges.empty() ? 1 : total_cost / edges.size();
+  delta = std::max(1u, delta);
+
+  if (argc > 3)
+    grain = strtoul(argv[3], NULL, 0);
+
+  graph.assemble(n_vertices, edges.data(), edges.size()).sort();
+  std::vector<graph_t::edge_t>().swap(edges);
+
+  if (s)
+    delta_stepping(s, max_cost);
+
+  for (vertex_t* v = vertices.iterator() ; v ; v = vertices.next(v)) {
+    if (!v->route)
+      continue;
+
+    std::cout << v->id.text << " "
+      << v->route->id.text << " "
+      << v->cost << std::endl;
+  }
+
+  vertices.forget();
+
+  vertices.reseat();
+  return EXIT_SUCCESS;
+}
+
+//
@@ -1,160 +1,387 @@
 #include <cstdlib>
 #include <cstring>
 #include <cassert>
+#include <climits>
 
 #include <iostream>
-#include <sstream>
-#include <string>
+#include <vector>
 
 #include <algorithm>
 
 #include <unistd.h>
+#include <fcntl.h>
 
 #include <lace/compare.h>
 #include "heap.h"
-#include "queue.h"
+#include "graph.h"
+#include "pool.h"
+#include "symbol.h"
 #include "table.h"
+#include "tokenizer.h"
 
-struct vertex_t;
-
-struct edge_t {
-  edge_t(vertex_t* f, vertex_t* t, unsigned w) : from(f), to(t), cost(w) { }
-
-  vertex_t* from;
-  vertex_t* to;
-  unsigned cost;
-
-  lite::queue_link<edge_t> from_link;
-  typedef lite::queue<edge_t, &edge_t::from_link> from_edges_t;
-  typedef from_edges_t::sorter<typeof(edge_t::cost), &edge_t::cost> from_edges_sorter;
-
-  bool
-  bound() const {
-    return false
-        || from_link.bound()
-        ;;
-  }
-
-  void kill() { if (!bound()) delete this; }
-};
+typedef lite::graph<unsigned> graph_t;
 
 struct vertex_t {
-  vertex_t(const char * c)
-    : id(strdup(c))
+  vertex_t(const lite::symbol & c, graph_t::index_t i)
+    : id(c)
+    , slot(i)
+    , estimate(0)
     , route(NULL)
+    , back_route(NULL)
   { }
-  ~vertex_t() { free(const_cast<char*>(id)); }
 
-  const char* id;
+  lite::symbol id;
+  graph_t::index_t slot;
   unsigned cost;
+  unsigned estimate;
+  unsigned key;
   vertex_t* route;
 
-  edge_t::from_edges_t from_edges;
+  unsigned back_cost;
+  unsigned back_key;
+  vertex_t* back_route;
 
   lite::table_link<vertex_t> v_link;
-  typedef lite::table<vertex_t, &vertex_t::v_link, typeof(vertex_t::id), &vertex_t::id> vertices_t;
+  typedef lite::table<vertex_t, &vertex_t::v_link, typeof(vertex_t::id), &vertex_t::id,
+                      lite::symbol::compare, lite::symbol::hash> vertices_t;
 
   lite::heap_link<vertex_t> q_link;
-  typedef lite::heap<vertex_t, &vertex_t::q_link, typeof(vertex_t::cost), &vertex_t::cost> pq_t;
+  typedef lite::heap<vertex_t, &vertex_t::q_link, typeof(vertex_t::key), &vertex_t::key> pq_t;
+
+  lite::heap_link<vertex_t> back_link;
+  typedef lite::heap<vertex_t, &vertex_t::back_link, typeof(vertex_t::back_key), &vertex_t::back_key> back_pq_t;
 
   bool
   bound() const {
     return false
         || v_link.bound()
         || q_link.bound()
+        || back_link.bound()
         ;;
   }
-
-  void kill() { if (!bound()) delete this; }
 };
 
+static graph_t graph;
+static graph_t reverse;
+static std::vector<vertex_t*> slots;
+
+// the greatest estimate, which keeps backward keys from going negative
+static unsigned ceiling = 0;
+
+// forward arcs are relaxed into cost & route, keyed on cost plus estimate,
+// which is zero unless a heuristic was given
+bool
+relax(vertex_t::pq_t & pq, vertex_t* v, const graph_t::arc_t & a) {
+  vertex_t* to = slots[a.to];
+  if (to == v)
+    return false;
+
+  unsigned cost = v->cost + a.cost;
+  if (to->route && cost >= to->cost)
+    return false;
+
+  to->cost = cost;
+  to->key = cost + to->estimate;
+  to->route = v;
+  pq.churn(to);
+  return true;
+}
+
+bool
+relax_back(vertex_t::back_pq_t & pq, vertex_t* v, const graph_t::arc_t & a) {
+  vertex_t* from = slots[a.to];
+  if (from == v)
+    return false;
+
+  unsigned cost = v->back_cost + a.cost;
+  if (from->back_route && cost >= from->back_cost)
+    return false;
+
+  from->back_cost = cost;
+  from->back_key = cost + ceiling - from->estimate;
+  from->back_route = v;
+  pq.churn(from);
+  return true;
+}
+
+void
+start(vertex_t::pq_t & pq, vertex_t* s) {
+  s->cost = 0;
+  s->key = s->estimate;
+  s->route = s;
+  pq.inhume(s);
+}
+
+void
+dijkstra(vertex_t* s) {
+  vertex_t::pq_t pq;
+  start(pq, s);
+
+  while (!pq.empty()) {
+    vertex_t* v = pq.exhume();
+
+    assert(v->route);
+    for (const graph_t::arc_t* a = graph.begin(v->slot) ; a != graph.end(v->slot) ; ++a)
+      relax(pq, v, *a);
+  }
+}
+
+// with an admissible estimate, the target's first exhumation is final;
+// vertices are reopened whenever they improve, so it need not be consistent,
+// which bidirectional requires
+bool
+astar(vertex_t* s, vertex_t* t) {
+  vertex_t::pq_t pq;
+  start(pq, s);
+
+  while (!pq.empty()) {
+    vertex_t* v = pq.exhume();
+    if (v == t) {
+      pq.forget();
+      return true;
+    }
+
+    for (const graph_t::arc_t* a = graph.begin(v->slot) ; a != graph.end(v->slot) ; ++a)
+      relax(pq, v, *a);
+  }
+
+  return false;
+}
+
+// whether no estimate falls by more than the cost of an arc, so that
+// costs less the drop in estimate along each arc are never negative
+bool
+consistent() {
+  for (graph_t::index_t u = 0 ; u < slots.size() ; ++u)
+    for (const graph_t::arc_t* a = graph.begin(u) ; a != graph.end(u) ; ++a)
+      if (slots[u]->estimate > a->cost + slots[a->to]->estimate)
+        return false;
+
+  return true;
+}
+
+// searches forward from s & backward from t, always expanding the nearer
+// frontier, until no path through either could beat the best meeting.
+// Given consistent estimates, the forward search is keyed on cost plus
+// estimate, & the backward on cost less estimate, so that both run over
+// the same reduced arc costs, cost + estimate(to) - estimate(from), which
+// are never negative; the stopping rule then holds as it does without
+// estimates, which are all zero
+vertex_t*
+bidirectional(vertex_t* s, vertex_t* t) {
+  typedef unsigned long long sum_t;
+
+  vertex_t::pq_t pq;
+  vertex_t::back_pq_t back_pq;
+
+  start(pq, s);
+  t->back_cost = 0;
+  t->back_key = ceiling - t->estimate;
+  t->back_route = t;
+  back_pq.inhume(t);
+
+  vertex_t* meet = s == t ? s : NULL;
+  unsigned best = meet ? 0 : UINT_MAX;
+
+  while (!pq.empty() && !back_pq.empty()) {
+    // the keys of both roots, each offset by the reduced cost of the
+    // whole path, against the best meeting so far
+    const sum_t forward = pq.root()->key;
+    const sum_t backward = back_pq.root()->back_key;
+    if (meet && forward + backward >= sum_t(best) + ceiling)
+      break;
+
+    // the nearer frontier, by reduced cost from its own end
+    if (forward + ceiling <= backward + s->estimate + t->estimate) {
+      vertex_t* v = pq.exhume();
+      for (const graph_t::arc_t* a = graph.begin(v->slot) ; a != graph.end(v->slot) ; ++a) {
+        vertex_t* to = slots[a->to];
+        if (relax(pq, v, *a) && to->back_route && to->cost + to->back_cost < best) {
+          best = to->cost + to->back_cost;
+          meet = to;
+        }
+      }
+    } else {
+      vertex_t* v = back_pq.exhume();
+      for (const graph_t::arc_t* a = reverse.begin(v->slot) ; a != reverse.end(v->slot) ; ++a) {
+        vertex_t* from = slots[a->to];
+        if (relax_back(back_pq, v, *a) && from->route && from->cost + from->back_cost < best) {
+          best = from->cost + from->back_cost;
+          meet = from;
+        }
+      }
+    }
+  }
+
+  pq.forget();
+  back_pq.forget();
+  return meet;
+}
+
+unsigned
+arc_cost(const vertex_t* u, const vertex_t* v) {
+  // arcs are sorted by cost, so the first match is the cheapest
+  for (const graph_t::arc_t* a = graph.begin(u->slot) ; a != graph.end(u->slot) ; ++a)
+    if (a->to == v->slot)
+      return a->cost;
+
+  assert(!"unreachable"), __builtin_unreachable();
+}
+
+void
+print(const std::vector<vertex_t*> & path) {
+  unsigned cost = 0;
+  for (size_t i = 0 ; i < path.size() ; ++i) {
+    const vertex_t* u = path[i ? i - 1 : 0];
+    const vertex_t* v = path[i];
+    if (i)
+      cost += arc_cost(u, v);
+
+    std::cout << v->id.text << " "
+      << u->id.text << " "
+      << cost << std::endl;
+  }
+}
+
 int
-main(int, char* argv[]) {
+main(int argc, char* argv[]) {
   const unsigned load = 2;
   unsigned n_vertices = 0;
+  lite::pool<vertex_t> vertex_pool;
+  lite::tokenizer input;
   vertex_t::vertices_t vertices;
+  std::vector<graph_t::edge_t> edges;
 
   vertex_t* s = NULL;
 
-  std::string line;
-  while (std::getline(std::cin, line)) {
-    if (line.empty() || '#' == line[0])
+  while (input.line()) {
+    const char* token = input.token();
+    if (!token || '#' == *token)
+      continue;
+    const lite::symbol from(token);
+
+    if (!(token = input.token()))
       continue;
+    const lite::symbol to(token);
 
-    std::stringstream ss(line);
-    std::string from, to;
-    unsigned cost = 1;
-    ss >> from >> to >> cost;
+    token = input.token();
+    unsigned cost = token ? strtoul(token, NULL, 10) : 1;
 
-    vertex_t* f = vertices.get(from.c_str());
+    vertex_t* f = vertices.get(from);
     if (!f) {
       ++n_vertices;
       if (vertices.buckets() < load * n_vertices)
         vertices.reseat((load+1) * (n_vertices+1));
-      vertices.set(f = new vertex_t(from.c_str()));
+      vertices.set(f = new (vertex_pool.allocate()) vertex_t(from, slots.size()));
+      slots.push_back(f);
     }
-    if (!s || lace::compare(f->id, s->id) < 0)
+    if (!s || lace::compare(f->id.text, s->id.text) < 0)
       s = f;
 
-    vertex_t* t = vertices.get(to.c_str());
+    vertex_t* t = vertices.get(to);
     if (!t) {
       ++n_vertices;
       if (vertices.buckets() < load * n_vertices)
         vertices.reseat((load+1) * (n_vertices+1));
-      vertices.set(t = new vertex_t(to.c_str()));
+      vertices.set(t = new (vertex_pool.allocate()) vertex_t(to, slots.size()));
+      slots.push_back(t);
     }
-    if (!s || lace::compare(t->id, s->id) < 0)
+    if (!s || lace::compare(t->id.text, s->id.text) < 0)
       s = t;
 
-    edge_t* e = new edge_t(f, t, cost);
-    f->from_edges.enqueue(e);
+    graph_t::edge_t e = { f->slot, t->slot, cost };
+    edges.push_back(e);
   }
 
-  for (vertex_t* v = vertices.iterator() ; v ; v = vertices.next(v))
-    edge_t::from_edges_sorter::sort(v->from_edges);
+  graph.assemble(n_vertices, edges.data(), edges.size()).sort();
 
-  vertex_t::pq_t pq;
-  if (s) {
-    s->cost = 0;
-    s->route = s;
-    pq.inhume(s);
-  }
+  if (argc > 2) {
+    vertex_t* source = vertices.get(lite::symbol(argv[1]));
+    vertex_t* target = vertices.get(lite::symbol(argv[2]));
+    if (!source || !target) {
+      std::cerr << "unknown " << (source ? argv[2] : argv[1]) << std::endl;
+      vertices.forget();
+      vertices.reseat();
+      return EXIT_FAILURE;
+    }
 
-  while (!pq.empty()) {
-    vertex_t* v = pq.exhume();
+    std::vector<vertex_t*> path;
 
-    assert(v->route);
-    edge_t::from_edges_t & fe = v->from_edges;
-    for (edge_t* e = fe.iterator() ; e ; e = fe.next(e)) {
-      assert(v == e->from);
-      if (e->to == e->from)
-        continue;
-      unsigned cost = e->from->cost + e->cost;
-      if (!e->to->route || cost < e->to->cost) {
-        e->to->cost = cost;
-        e->to->route = e->from;
-        pq.churn(e->to);
+    if (argc > 3) {
+      int fd = open(argv[3], O_RDONLY);
+      if (fd < 0) {
+        perror(argv[3]);
+        vertices.forget();
+        vertices.reseat();
+        return EXIT_FAILURE;
+      }
+
+      lite::tokenizer estimates(fd);
+      close(fd);
+
+      while (estimates.line()) {
+        const char* token = estimates.token();
+        if (!token || '#' == *token)
+          continue;
+        vertex_t* v = vertices.get(lite::symbol(token));
+
+        if ((token = estimates.token()) && v)
+          ceiling = std::max(ceiling, v->estimate = strtoul(token, NULL, 10));
       }
     }
+
+    if (argc > 3 && !consistent()) {
+      if (astar(source, target))
+        for (vertex_t* v = target ; ; v = v->route) {
+          path.push_back(v);
+          if (v == source)
+            break;
+        }
+
+      std::reverse(path.begin(), path.end());
+    } else {
+      for (size_t i = 0 ; i < edges.size() ; ++i)
+        std::swap(edges[i].from, edges[i].to);
+      reverse.assemble(n_vertices, edges.data(), edges.size()).sort();
+
+      if (vertex_t* meet = bidirectional(source, target)) {
+        for (vertex_t* v = meet ; ; v = v->route) {
+          path.push_back(v);
+          if (v == source)
+            break;
+        }
+
+        std::reverse(path.begin(), path.end());
+
+        for (vertex_t* v = meet ; v != target ; ) {
+          v = v->back_route;
+          path.push_back(v);
+        }
+      }
+    }
+
+    print(path);
+
+    vertices.forget();
+    vertices.reseat();
+    return path.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
   }
 
+  std::vector<graph_t::edge_t>().swap(edges);
+
+  if (s)
+    dijkstra(s);
+
   for (vertex_t* v = vertices.iterator() ; v ; v = vertices.next(v)) {
     if (!v->route)
       continue;
 
-    std::cout << v->id << " "
-      << v->route->id << " "
+    std::cout << v->id.text << " "
+      << v->route->id.text << " "
       << v->cost << std::endl;
   }
 
-  vertex_t* v = vertices.iterator();
-  while (v) {
-    while (!v->from_edges.empty())
-      v->from_edges.dequeue()->kill();
-    vertex_t* x = vertices.next(v);
-    std::swap(x, v);
-    vertices.bus(x)->kill();
-  }
+  vertices.forget();
 
   vertices.reseat();
   return EXIT_SUCCESS;
@@ -0,0 +1,292 @@
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <climits>
+#include <stdint.h>
+
+#include <iostream>
+#include <thread>
+
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "pool.h"
+#include "set.h"
+#include "queue.h"
+#include "symbol.h"
+#include "table.h"
+#include "tokenizer.h"
+
+struct vertex_t;
+
+struct edge_t {
+  edge_t(vertex_t* f, vertex_t* t, unsigned w) : from(f), to(t), cost(w) { }
+
+  vertex_t* from;
+  vertex_t* to;
+  unsigned cost;
+
+  lite::queue_link<edge_t> link;
+  typedef lite::queue<edge_t, &edge_t::link> queue_t;
+  typedef queue_t::sorter<typeof(edge_t::cost), &edge_t::cost> sorter_t;
+
+  bool
+  bound() const {
+    return false
+        || link.bound()
+        ;;
+  }
+};
+
+struct vertex_t {
+  vertex_t(const lite::symbol & c) : id(c) { }
+
+  lite::symbol id;
+
+  lite::table_link<vertex_t> table_link;
+  typedef lite::table<vertex_t, &vertex_t::table_link, typeof(vertex_t::id), &vertex_t::id,
+                      lite::symbol::compare, lite::symbol::hash> table_t;
+
+  lite::atomic_forest_link<vertex_t> set_link;
+  typedef lite::atomic_forest<vertex_t, &vertex_t::set_link> set_t;
+
+  bool
+  bound() const {
+    return false
+        || table_link.bound()
+        || set_link.bound()
+        ;;
+  }
+
+  bool unify(vertex_t* that) { return set_t::join(this, that); }
+  bool unified(vertex_t* that) { return set_t::contains(this, that); }
+};
+
+// reservoir of edge costs, from which pivots are drawn
+struct sample_t {
+  static const unsigned size = 15;
+
+  unsigned min, max;
+  unsigned seen;
+  unsigned costs[size];
+  uint64_t state;
+
+  sample_t() : min(UINT_MAX), max(0), seen(0), state(0) { }
+
+  void reset(uint64_t seed) {
+    min = UINT_MAX;
+    max = seen = 0;
+    state = seed | 1;
+  }
+
+  void note(unsigned cost) {
+    min = std::min(min, cost);
+    max = std::max(max, cost);
+
+    if (seen < size) {
+      costs[seen] = cost;
+    } else {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      uint64_t i = state % (seen + 1);
+      if (i < size)
+        costs[i] = cost;
+    }
+
+    ++seen;
+  }
+};
+
+// edges spread over one queue per thread, so no pass ever has to split
+struct batch_t {
+  static const unsigned most = 64;
+
+  edge_t::queue_t chunks[most];
+  sample_t samples[most];
+
+  unsigned size() const {
+    unsigned n = 0;
+    for (unsigned i = 0 ; i < most ; ++i)
+      n += chunks[i].size();
+    return n;
+  }
+
+  unsigned min() const {
+    unsigned m = UINT_MAX;
+    for (unsigned i = 0 ; i < most ; ++i)
+      m = std::min(m, samples[i].min);
+    return m;
+  }
+
+  unsigned max() const {
+    unsigned m = 0;
+    for (unsigned i = 0 ; i < most ; ++i)
+      m = std::max(m, samples[i].max);
+    return m;
+  }
+
+  unsigned pivot() const {
+    unsigned costs[most * sample_t::size];
+    unsigned n = 0;
+    for (unsigned i = 0 ; i < most ; ++i)
+      for (unsigned j = 0 ; j < std::min(samples[i].seen, sample_t::size) ; ++j)
+        costs[n++] = samples[i].costs[j];
+
+    assert(n);
+    std::nth_element(costs, costs + n / 2, costs + n);
+    return costs[n / 2];
+  }
+};
+
+const unsigned sample_t::size;
+const unsigned batch_t::most;
+
+static unsigned threads = 1;
+
+// batches this small are sorted outright rather than partitioned
+static unsigned base = 1 << 12;
+
+void
+sift(unsigned t, batch_t* in, unsigned pivot, bool strict,
+     batch_t* light, batch_t* heavy) {
+  edge_t::queue_t & q = in->chunks[t];
+
+  light->samples[t].reset(2 * t + 1);
+  heavy->samples[t].reset(2 * t + 2);
+
+  while (!q.empty()) {
+    edge_t* e = q.dequeue();
+
+    if (e->from->unified(e->to))
+      continue;
+
+    batch_t* b = (strict ? e->cost < pivot : e->cost <= pivot) ? light : heavy;
+    b->chunks[t].enqueue(e);
+    b->samples[t].note(e->cost);
+  }
+}
+
+void
+kruskal(batch_t & b) {
+  edge_t::queue_t q;
+  for (unsigned t = 0 ; t < threads ; ++t)
+    if (!b.chunks[t].empty())
+      q.chain(b.chunks[t]);
+
+  edge_t::sorter_t::sort(q);
+
+  while (!q.empty()) {
+    edge_t* e = q.dequeue();
+    if (e->from->unify(e->to))
+      std::cout
+        << e->from->id.text << " "
+        << e->to->id.text << " "
+        << e->cost << std::endl;
+  }
+}
+
+// edges whose ends are already joined by lighter ones are filtered out
+// as the heavier side is partitioned, one thread per chunk
+void
+filter_kruskal(batch_t & b) {
+  while (const unsigned size = b.size()) {
+    const unsigned min = b.min();
+    const unsigned max = b.max();
+    if (size <= base || min == max)
+      return kruskal(b);
+
+    // when the pivot is the greatest cost, split below it instead, so
+    // that neither side can be empty
+    const unsigned pivot = b.pivot();
+    const bool strict = pivot == max;
+
+    batch_t light, heavy;
+
+    if (threads > 1 && size >= threads * base) {
+      std::thread ts[batch_t::most];
+      for (unsigned t = 0 ; t < threads ; ++t)
+        ts[t] = std::thread(sift, t, &b, pivot, strict, &light, &heavy);
+      for (unsigned t = 0 ; t < threads ; ++t)
+        ts[t].join();
+    } else {
+      for (unsigned t = 0 ; t < threads ; ++t)
+        sift(t, &b, pivot, strict, &light, &heavy);
+    }
+
+    filter_kruskal(light);
+
+    // loop on the heavier side rather than recursing
+    for (unsigned t = 0 ; t < threads ; ++t) {
+      if (!heavy.chunks[t].empty())
+        b.chunks[t].chain(heavy.chunks[t]);
+      b.samples[t] = heavy.samples[t];
+    }
+  }
+}
+
+int
+main(int argc, char* argv[]) {
+  const unsigned load = 2;
+  unsigned n_vertices = 0;
+  unsigned n_edges = 0;
+
+  threads = argc > 1 ? strtoul(argv[1], NULL, 0) : std::thread::hardware_concurrency();
+  threads = std::max(1u, std::min(batch_t::most, threads));
+  if (argc > 2)
+    base = std::max(1ul, strtoul(argv[2], NULL, 0));
+
+  lite::pool<edge_t> edge_pool;
+  lite::pool<vertex_t> vertex_pool;
+
+  batch_t edges;
+  for (unsigned t = 0 ; t < threads ; ++t)
+    edges.samples[t].reset(t + 1);
+
+  lite::tokenizer input;
+  vertex_t::table_t vertices;
+
+  while (input.line()) {
+    const char* token = input.token();
+    if (!token || '#' == *token)
+      continue;
+    const lite::symbol from(token);
+
+    if (!(token = input.token()))
+      continue;
+    const lite::symbol to(token);
+
+    token = input.token();
+    unsigned cost = token ? strtoul(token, NULL, 10) : 1;
+
+    vertex_t* f = vertices.get(from);
+    if (!f) {
+      ++n_vertices;
+      if (vertices.buckets() < load * n_vertices)
+        vertices.reseat((load+1) * (n_vertices+1));
+      vertices.set(f = new (vertex_pool.allocate()) vertex_t(from));
+    }
+
+    vertex_t* t = vertices.get(to);
+    if (!t) {
+      ++n_vertices;
+      if (vertices.buckets() < load * n_vertices)
+        vertices.reseat((load+1) * (n_vertices+1));
+      vertices.set(t = new (vertex_pool.allocate()) vertex_t(to));
+    }
+
+    unsigned i = n_edges++ % threads;
+    edges.chunks[i].enqueue(new (edge_pool.allocate()) edge_t(f, t, cost));
+    edges.samples[i].note(cost);
+  }
+
+  filter_kruskal(edges);
+
+  vertices.forget();
+
+  vertices.reseat();
+  return EXIT_SUCCESS;
+}
+
+//
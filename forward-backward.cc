@@ -0,0 +1,325 @@
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "graph.h"
+#include "pool.h"
+#include "queue.h"
+#include "symbol.h"
+#include "table.h"
+#include "tokenizer.h"
+
+typedef lite::graph<unsigned> graph_t;
+
+struct vertex_t {
+  vertex_t(const lite::symbol & c, graph_t::index_t i)
+    : id(c)
+    , slot(i)
+    , color(0)
+    , forward(0)
+    , backward(0)
+    , in(0)
+    , out(0)
+  { }
+
+  lite::symbol id;
+  graph_t::index_t slot;
+
+  // vertices sharing a color form one subproblem; colors are never reused,
+  // & a vertex is only recolored by the task owning it
+  std::atomic<unsigned> color;
+
+  // the color of the last subproblem whose pivot reached this vertex
+  unsigned forward, backward;
+
+  // live degrees, while trimming
+  unsigned in, out;
+
+  lite::table_link<vertex_t> table_link;
+  typedef lite::table<vertex_t, &vertex_t::table_link, typeof(vertex_t::id), &vertex_t::id,
+                      lite::symbol::compare, lite::symbol::hash> table_t;
+
+  // membership of a subproblem
+  lite::queue_link<vertex_t> member_link;
+  typedef lite::queue<vertex_t, &vertex_t::member_link> members_t;
+
+  // frontiers of the two searches, which may run at once
+  lite::queue_link<vertex_t> forward_link;
+  typedef lite::queue<vertex_t, &vertex_t::forward_link> forward_t;
+  lite::queue_link<vertex_t> backward_link;
+  typedef lite::queue<vertex_t, &vertex_t::backward_link> backward_t;
+
+  unsigned hue() const { return color.load(std::memory_order_relaxed); }
+  void paint(unsigned c) { color.store(c, std::memory_order_relaxed); }
+
+  bool
+  bound() const {
+    return false
+        || table_link.bound()
+        || member_link.bound()
+        || forward_link.bound()
+        || backward_link.bound()
+        ;;
+  }
+};
+
+struct task_t {
+  unsigned color;
+  vertex_t::members_t members;
+
+  lite::queue_link<task_t> link;
+  typedef lite::queue<task_t, &task_t::link> queue_t;
+};
+
+static const unsigned most = 64;
+// tasks with fewer members than this search forward & backward in turn
+static size_t grain = 1 << 14;
+
+static unsigned threads = 1;
+
+static graph_t graph;
+static graph_t reverse;
+static std::vector<vertex_t*> slots;
+
+static std::atomic<unsigned> colors(1);
+
+static std::mutex output;
+
+static std::mutex lock;
+static std::condition_variable ready;
+static task_t::queue_t tasks;
+static unsigned outstanding = 0;
+
+void
+submit(task_t* t) {
+  std::lock_guard<std::mutex> guard(lock);
+  tasks.enqueue(t);
+  ++outstanding;
+  ready.notify_one();
+}
+
+// marks every vertex of color c reachable from the pivot along g, stamping
+// it with c through the given member
+template <class Q>
+void
+reach(const graph_t & g, vertex_t* pivot, unsigned vertex_t::*mark) {
+  const unsigned c = pivot->hue();
+
+  Q frontier;
+  pivot->*mark = c;
+  frontier.enqueue(pivot);
+
+  while (!frontier.empty()) {
+    vertex_t* v = frontier.dequeue();
+    for (const graph_t::arc_t* a = g.begin(v->slot) ; a != g.end(v->slot) ; ++a) {
+      vertex_t* w = slots[a->to];
+      if (w->hue() != c || w->*mark == c)
+        continue;
+
+      w->*mark = c;
+      frontier.enqueue(w);
+    }
+  }
+}
+
+// the vertices reached both ways from the pivot form its component; those
+// reached one way only, or neither, are split off as three new subproblems,
+// as no component can straddle them
+void
+split(task_t* t) {
+  vertex_t* pivot = t->members.peek();
+  assert(pivot->hue() == t->color);
+
+  if (threads > 1 && t->members.size() >= grain) {
+    std::thread f(reach<vertex_t::forward_t>, std::cref(graph), pivot, &vertex_t::forward);
+    reach<vertex_t::backward_t>(reverse, pivot, &vertex_t::backward);
+    f.join();
+  } else {
+    reach<vertex_t::forward_t>(graph, pivot, &vertex_t::forward);
+    reach<vertex_t::backward_t>(reverse, pivot, &vertex_t::backward);
+  }
+
+  task_t* parts[3] = { new task_t, new task_t, new task_t };
+  for (unsigned i = 0 ; i < 3 ; ++i)
+    parts[i]->color = colors++;
+
+  std::ostringstream component;
+  while (!t->members.empty()) {
+    vertex_t* v = t->members.dequeue();
+
+    const bool f = v->forward == t->color;
+    const bool b = v->backward == t->color;
+    if (f && b) {
+      if (v != pivot)
+        component << ' ';
+      component << v->id.text;
+      continue;
+    }
+
+    task_t* part = parts[f ? 0 : b ? 1 : 2];
+    v->paint(part->color);
+    part->members.enqueue(v);
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(output);
+    std::cout << component.str() << std::endl;
+  }
+
+  for (unsigned i = 0 ; i < 3 ; ++i)
+    if (!parts[i]->members.empty())
+      submit(parts[i]);
+    else
+      delete parts[i];
+}
+
+void
+work() {
+  for (;;) {
+    task_t* t;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      ready.wait(guard, [] { return !tasks.empty() || !outstanding; });
+      if (tasks.empty())
+        return;
+      t = tasks.dequeue();
+    }
+
+    split(t);
+    delete t;
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (!--outstanding)
+      ready.notify_all();
+  }
+}
+
+// vertices with no live arcs in, or none out, are components by
+// themselves; peeling them off first leaves far fewer for the searches
+void
+trim(std::vector<vertex_t*> & trivial) {
+  for (size_t i = 0 ; i < slots.size() ; ++i) {
+    vertex_t* v = slots[i];
+    v->out = graph.degree(v->slot);
+    v->in = reverse.degree(v->slot);
+    if (!v->in || !v->out)
+      trivial.push_back(v);
+  }
+
+  for (size_t i = 0 ; i < trivial.size() ; ++i) {
+    vertex_t* v = trivial[i];
+    v->paint(0);
+
+    for (const graph_t::arc_t* a = graph.begin(v->slot) ; a != graph.end(v->slot) ; ++a) {
+      vertex_t* w = slots[a->to];
+      if (w->hue() && w->in && !--w->in && w->out)
+        trivial.push_back(w);
+    }
+
+    for (const graph_t::arc_t* a = reverse.begin(v->slot) ; a != reverse.end(v->slot) ; ++a) {
+      vertex_t* w = slots[a->to];
+      if (w->hue() && w->out && !--w->out && w->in)
+        trivial.push_back(w);
+    }
+  }
+}
+
+int
+main(int argc, char* argv[]) {
+  const unsigned load = 2;
+  unsigned n_vertices = 0;
+
+  threads = argc > 1 ? strtoul(argv[1], NULL, 0) : std::thread::hardware_concurrency();
+  threads = std::max(1u, std::min(most, threads));
+  if (argc > 2)
+    grain = strtoul(argv[2], NULL, 0);
+
+  lite::pool<vertex_t> vertex_pool;
+  lite::tokenizer input;
+  vertex_t::table_t vertices;
+  std::vector<graph_t::edge_t> edges;
+
+  while (input.line()) {
+    const char* token = input.token();
+    if (!token || '#' == *token)
+      continue;
+    const lite::symbol from(token);
+
+    if (!(token = input.token()))
+      continue;
+    const lite::symbol to(token);
+
+    vertex_t* f = vertices.get(from);
+    if (!f) {
+      ++n_vertices;
+      if (vertices.buckets() < load * n_vertices)
+        vertices.reseat((load+1) * (n_vertices+1));
+      vertices.set(f = new (vertex_pool.allocate()) vertex_t(from, slots.size()));
+      slots.push_back(f);
+    }
+
+    vertex_t* t = vertices.get(to);
+    if (!t) {
+      ++n_vertices;
+      if (vertices.buckets() < load * n_vertices)
+        vertices.reseat((load+1) * (n_vertices+1));
+      vertices.set(t = new (vertex_pool.allocate()) vertex_t(to, slots.size()));
+      slots.push_back(t);
+    }
+
+    graph_t::edge_t e = { f->slot, t->slot, 0 };
+    edges.push_back(e);
+  }
+
+  graph.assemble(n_vertices, edges.data(), edges.size());
+  for (size_t i = 0 ; i < edges.size() ; ++i)
+    std::swap(edges[i].from, edges[i].to);
+  reverse.assemble(n_vertices, edges.data(), edges.size());
+  std::vector<graph_t::edge_t>().swap(edges);
+
+  task_t* all = new task_t;
+  all->color = colors++;
+  for (size_t i = 0 ; i < slots.size() ; ++i)
+    slots[i]->paint(all->color);
+
+  std::vector<vertex_t*> trivial;
+  trim(trivial);
+  for (size_t i = 0 ; i < trivial.size() ; ++i)
+    std::cout << trivial[i]->id.text << std::endl;
+
+  for (size_t i = 0 ; i < slots.size() ; ++i)
+    if (slots[i]->hue())
+      all->members.enqueue(slots[i]);
+
+  if (all->members.empty()) {
+    delete all;
+  } else {
+    submit(all);
+
+    std::thread ts[most];
+    for (unsigned t = 1 ; t < threads ; ++t)
+      ts[t] = std::thread(work);
+    work();
+    for (unsigned t = 1 ; t < threads ; ++t)
+      ts[t].join();
+  }
+
+  vertices.forget();
+
+  vertices.reseat();
+  return EXIT_SUCCESS;
+}
+
+//
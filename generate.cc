@@ -0,0 +1,161 @@
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <stdint.h>
+
+#include <iostream>
+#include <vector>
+
+#include <algorithm>
+
+#include <unistd.h>
+
+// xorshift, so that a given seed always yields the same input
+struct random_t {
+  uint64_t state;
+  random_t(uint64_t seed) : state(seed * 2654435761ULL | 1) { }
+
+  uint64_t operator()() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  uint64_t below(uint64_t n) { return (*this)() % n; }
+  double unit() { return ((*this)() >> 11) * (1.0 / (1ULL << 53)); }
+};
+
+static const unsigned max_cost = 100;
+
+void
+edge(uint64_t from, uint64_t to, random_t & rng) {
+  std::cout << from << ' ' << to << ' ' << 1 + rng.below(max_cost) << '\n';
+}
+
+// m arcs between uniformly chosen ends
+void
+erdos_renyi(uint64_t n, uint64_t m, random_t & rng) {
+  for (uint64_t i = 0 ; i < m ; ++i)
+    edge(rng.below(n), rng.below(n), rng);
+}
+
+// preferential attachment: each new vertex links to k earlier ones, picked
+// in proportion to degree by sampling the ends of arcs so far; arcs point
+// either way, so that cycles, & with them components, form
+void
+power_law(uint64_t n, uint64_t k, random_t & rng) {
+  std::vector<uint64_t> ends;
+  ends.reserve(2 * n * k);
+  ends.push_back(0);
+
+  for (uint64_t v = 1 ; v < n ; ++v) {
+    for (uint64_t j = 0 ; j < k ; ++j) {
+      uint64_t u = ends[rng.below(ends.size())];
+      if (rng() & 1)
+        edge(v, u, rng);
+      else
+        edge(u, v, rng);
+      ends.push_back(u);
+    }
+    ends.push_back(v);
+  }
+}
+
+// a square lattice with arcs both ways, like a road network
+void
+grid(uint64_t n, random_t & rng) {
+  const uint64_t side = std::max<uint64_t>(1, sqrt(double(n)));
+  for (uint64_t r = 0 ; r < side ; ++r) {
+    for (uint64_t c = 0 ; c < side ; ++c) {
+      const uint64_t v = r * side + c;
+      if (c + 1 < side) {
+        edge(v, v + 1, rng);
+        edge(v + 1, v, rng);
+      }
+      if (r + 1 < side) {
+        edge(v, v + side, rng);
+        edge(v + side, v, rng);
+      }
+    }
+  }
+}
+
+// n draws from 1..domain with probability proportional to 1/rank^s
+void
+zipf(uint64_t n, uint64_t domain, double s, random_t & rng) {
+  std::vector<double> cdf(domain);
+  double sum = 0;
+  for (uint64_t i = 0 ; i < domain ; ++i)
+    cdf[i] = sum += pow(double(i + 1), -s);
+
+  for (uint64_t i = 0 ; i < n ; ++i) {
+    double u = rng.unit() * sum;
+    std::cout << 1 + (std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin()) << '\n';
+  }
+}
+
+// 1..n ascending, descending, shuffled, or ascending with a few percent
+// of the values swapped with a near neighbour
+void
+ints(uint64_t n, const char* order, random_t & rng) {
+  std::vector<uint64_t> v(n);
+  for (uint64_t i = 0 ; i < n ; ++i)
+    v[i] = i + 1;
+
+  if (!strcmp(order, "reverse")) {
+    std::reverse(v.begin(), v.end());
+  } else if (!strcmp(order, "nearly")) {
+    for (uint64_t i = 0 ; i < (n + 31) / 32 ; ++i) {
+      uint64_t a = rng.below(n);
+      uint64_t b = std::min(n - 1, a + rng.below(16));
+      std::swap(v[a], v[b]);
+    }
+  } else if (!strcmp(order, "random")) {
+    for (uint64_t i = n ; i > 1 ; --i)
+      std::swap(v[i - 1], v[rng.below(i)]);
+  }
+
+  for (uint64_t i = 0 ; i < n ; ++i)
+    std::cout << v[i] << '\n';
+}
+
+int
+usage(const char* self) {
+  std::cerr << "usage: " << self << " kind n [seed]" << std::endl
+    << "  graphs: erdos-renyi, power-law, grid" << std::endl
+    << "  ints:   zipf, sorted, reverse, nearly, random" << std::endl;
+  return EXIT_FAILURE;
+}
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 3)
+    return usage(argv[0]);
+
+  const char* kind = argv[1];
+  const uint64_t n = strtoull(argv[2], NULL, 0);
+  random_t rng(argc > 3 ? strtoull(argv[3], NULL, 0) : 1);
+
+  std::ios::sync_with_stdio(false);
+
+  if (!strcmp(kind, "erdos-renyi"))
+    erdos_renyi(n, 4 * n, rng);
+  else if (!strcmp(kind, "power-law"))
+    power_law(n, 4, rng);
+  else if (!strcmp(kind, "grid"))
+    grid(n, rng);
+  else if (!strcmp(kind, "zipf"))
+    zipf(n, std::max<uint64_t>(1, std::min<uint64_t>(n, 1 << 20)), 1.0, rng);
+  else if (!strcmp(kind, "sorted") || !strcmp(kind, "reverse")
+        || !strcmp(kind, "nearly") || !strcmp(kind, "random"))
+    ints(n, kind, rng);
+  else
+    return usage(argv[0]);
+
+  std::cout.flush();
+  return EXIT_SUCCESS;
+}
+
+//
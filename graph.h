@@ -0,0 +1,102 @@
+#ifndef LITE__GRAPH_H
+#define LITE__GRAPH_H
+
+#include <lace/do_not_copy.h>
+
+#include <lace/compare.h>
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+
+namespace lite {
+
+template <typename W>
+class graph : public lace::do_not_copy {
+public:
+  typedef unsigned index_t;
+
+  struct edge_t {
+    index_t from, to;
+    W cost;
+  };
+
+  struct arc_t {
+    index_t to;
+    W cost;
+  };
+
+  graph() : n_vertices_(0), offsets_(NULL), arcs_(NULL) { }
+  ~graph() { clear(); }
+
+  bool empty() const { return !n_vertices_; }
+
+  // counting sort by source, so each vertex keeps its arcs in input order
+  graph & assemble(const size_t n_vertices, const edge_t edges[], const size_t n_edges) {
+    clear();
+
+    n_vertices_ = n_vertices;
+    offsets_ = new size_t[n_vertices_ + 1];
+    arcs_ = new arc_t[n_edges];
+
+    std::fill(offsets_, offsets_ + n_vertices_ + 1, 0);
+    for (size_t i = 0 ; i < n_edges ; ++i) {
+      assert(edges[i].from < n_vertices_);
+      assert(edges[i].to < n_vertices_);
+      ++offsets_[edges[i].from + 1];
+    }
+
+    for (size_t v = 0 ; v < n_vertices_ ; ++v)
+      offsets_[v + 1] += offsets_[v];
+
+    for (size_t i = 0 ; i < n_edges ; ++i) {
+      arc_t & a = arcs_[offsets_[edges[i].from]++];
+      a.to = edges[i].to;
+      a.cost = edges[i].cost;
+    }
+
+    for (size_t v = n_vertices_ ; v > 0 ; --v)
+      offsets_[v] = offsets_[v - 1];
+    offsets_[0] = 0;
+
+    assert(arcs() == n_edges);
+    return *this;
+  }
+
+  template <lace::compare_t (*C)(W const &, W const &) = lace::compare<W> >
+  graph & sort() {
+    for (size_t v = 0 ; v < n_vertices_ ; ++v)
+      std::stable_sort(&arcs_[offsets_[v]], &arcs_[offsets_[v + 1]], less<C>);
+    return *this;
+  }
+
+  size_t vertices() const { return n_vertices_; }
+  size_t arcs() const { return n_vertices_ ? offsets_[n_vertices_] : 0; }
+
+  size_t degree(index_t v) const { return end(v) - begin(v); }
+
+  const arc_t* begin(index_t v) const { assert(v < n_vertices_); return &arcs_[offsets_[v]]; }
+  const arc_t* end(index_t v) const { assert(v < n_vertices_); return &arcs_[offsets_[v + 1]]; }
+
+private:
+  size_t n_vertices_;
+  size_t * offsets_;
+  arc_t * arcs_;
+
+  template <lace::compare_t (*C)(W const &, W const &)>
+  static bool less(const arc_t & foo, const arc_t & bar) {
+    return C(foo.cost, bar.cost) < 0;
+  }
+
+  void clear() {
+    delete [] offsets_;
+    delete [] arcs_;
+    offsets_ = NULL;
+    arcs_ = NULL;
+    n_vertices_ = 0;
+  }
+};
+
+} // namespace lite
+
+#endif//LITE__GRAPH_H
@@ -3,11 +3,13 @@
 
 #include <lace/do_not_copy.h>
 #include "link.h"
+#include "order.h"
 
 #include <lace/compare.h>
 
 #include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <algorithm>
 
 namespace lite {
@@ -17,7 +19,8 @@ class heap_link {
 public:
   typedef heap_link type;
   template <class T, typename heap_link<T>::type T::*L,
-            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &)>
+            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &),
+            class S>
     friend class heap;
 
   bool bound() const {
@@ -30,10 +33,63 @@ private:
   link<X> c;
 };
 
+// the default statistics policy, which records nothing & costs nothing
+struct heap_nostats {
+  struct snapshot_t { };
+
+  void passed(size_t) const { }
+  void climbed(size_t) const { }
+
+  snapshot_t snapshot() const { return snapshot_t(); }
+};
+
+// histograms the children walked by each pairing pass & the siblings walked
+// to find the parent in each rehume; bin b holds walks shorter than 2^b
+struct heap_stats {
+  static const unsigned bins = 32;
+
+  struct snapshot_t {
+    unsigned long long passes, pass_children;
+    unsigned long long rehumes, parent_siblings;
+    unsigned long long pass_walks[bins];
+    unsigned long long parent_walks[bins];
+  };
+
+  heap_stats() { memset(&counts_, 0, sizeof(counts_)); }
+
+  void passed(size_t children) const {
+    ++counts_.passes;
+    counts_.pass_children += children;
+    ++counts_.pass_walks[bin(children)];
+  }
+
+  void climbed(size_t siblings) const {
+    ++counts_.rehumes;
+    counts_.parent_siblings += siblings;
+    ++counts_.parent_walks[bin(siblings)];
+  }
+
+  snapshot_t snapshot() const { return counts_; }
+
+private:
+  mutable snapshot_t counts_;
+
+  static unsigned bin(size_t walked) {
+    unsigned b = 0;
+    while (walked && b < bins - 1) {
+      walked >>= 1;
+      ++b;
+    }
+    return b;
+  }
+};
+
 template <class T, typename heap_link<T>::type T::*L,
-          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &) = lace::compare<K> >
-class heap : public lace::do_not_copy {
+          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &) = lace::compare<K>,
+          class S = heap_nostats>
+class heap : public lace::do_not_copy, private S {
 public:
+  typedef typename S::snapshot_t stats_t;
 
   heap() : root_(NULL) { }
   ~heap() { assert(empty()); }
@@ -110,8 +166,10 @@ public:
     if (t == root_)
       return false;
 
-    T* p = parent(t);
-    if (compare(p, t) <= 0)
+    size_t walked = 0;
+    T* p = parent(t, walked);
+    S::climbed(walked);
+    if (!before(t, p))
       return false;
 
     orphan(t, p);
@@ -131,12 +189,12 @@ public:
     if (!child(t))
       return *this;
 
-    if (!sibling(child(t)) && compare(t, child(t)) <= 0)
+    if (!sibling(child(t)) && !before(child(t), t))
       return *this;
 
     T* cs = pass(t);
 
-    if (compare(t, cs) <= 0) {
+    if (!before(cs, t)) {
        make_child(t, cs);
     } else if (t == root_) {
       link_parent(NULL, cs);
@@ -178,9 +236,20 @@ public:
     return NULL;
   }
 
+  // empties the heap without exhuming, leaving the nodes' links stale
+  heap & forget() { root_ = NULL; return *this; }
+
+  stats_t stats() const { return S::snapshot(); }
+
 private:
+  typedef order<K, C> order_t;
+
   T * root_;
 
+  static bool before(const T* foo, const T* bar) {
+    return order_t::less(foo->*key, bar->*key);
+  }
+
   static bool is_bound(const T* n) { assert(n); return (n->*L).bound(); }
   static bool is_baby(const T* n) { assert(n); return (n->*L).s.tagged(); }
 
@@ -194,12 +263,21 @@ private:
     return (n->*L).s.tagless();
   }
 
+  static T* parent(const T* n, size_t & walked) {
+    assert(n);
+    while (const T* s = sibling(n)) {
+      n = s;
+      ++walked;
+    }
+    return (n->*L).s.tagless();
+  }
+
   T* meld(T* foo, T* bar) {
     assert(foo);
     assert(bar);
 
     using std::swap;
-    if (compare(bar, foo) < 0)
+    if (before(bar, foo))
       swap(foo, bar);
 
     assert(!sibling(bar));
@@ -212,15 +290,20 @@ private:
     assert(child(t));
 
     // pairing pass
+    size_t children = 0;
     T* r = NULL;
     while (child(t)) {
       T* c = take_child(t);
-      if (child(t))
+      ++children;
+      if (child(t)) {
         c = meld(c, take_child(t));
+        ++children;
+      }
       link_sibling(c, r);
       r = c;
     }
     assert(r);
+    S::passed(children);
 
     // melding pass
     T* ss = take_siblings(r);
@@ -343,18 +426,24 @@ private:
   }
 
 #ifndef NDEBUG
+  // t & its descendants, but not its siblings, which its parent visits;
+  // the parent is recorded only at the end of the sibling chain, so it
+  // is checked once per chain rather than walked to from every child
   bool valid(const T* t) const {
-    if (!t)
-      return true;
+    assert(t);
 
     if (!is_bound(t))
       return false;
 
-    for (T* c = child(t) ; c ; c = sibling(c))
-      if (compare(c, t) < 0 || parent(c) != t || !valid(c))
+    const T* c = child(t);
+    if (c && parent(c) != t)
+      return false;
+
+    for ( ; c ; c = sibling(c))
+      if (compare(c, t) < 0 || !valid(c))
         return false;
 
-    return valid(sibling(t));
+    return true;
   }
 
   bool valid() const {
@@ -368,6 +457,87 @@ private:
 
 };
 
+template <class T, typename heap_link<T>::type T::*L,
+          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &) = lace::compare<K>,
+          class S = heap_nostats>
+class bounded_heap : public lace::do_not_copy {
+public:
+  typedef heap<T, L, K, key, C, S> heap_t;
+  typedef typename heap_t::stats_t stats_t;
+
+  bounded_heap(unsigned k) : capacity_(k), size_(0) { assert(capacity_); }
+  ~bounded_heap() { assert(empty()); }
+
+  bool empty() const { assert(!size_ == heap_.empty()); return !size_; }
+  bool full() const { return size_ >= capacity_; }
+
+  unsigned size() const { return size_; }
+  unsigned capacity() const { return capacity_; }
+
+  static
+  lace::compare_t compare(const T* foo, const T* bar) {
+    return heap_t::compare(foo, bar);
+  }
+
+  // keeps the k greatest; returns whichever node did not make the cut
+  T* inhume(T* t) {
+    assert(!(t->*L).bound());
+
+    if (full() && compare(t, heap_.root()) <= 0)
+      return t;
+
+    heap_.inhume(t);
+
+    if (++size_ <= capacity_)
+      return NULL;
+
+    return exhume();
+  }
+
+  T* exhume() {
+    assert(!empty());
+    --size_;
+    return heap_.exhume();
+  }
+
+  T* sift(T* t) {
+    assert(!empty());
+    --size_;
+    return heap_.sift(t);
+  }
+
+  bounded_heap & bury(T* t) {
+    heap_.bury(t);
+    return *this;
+  }
+
+  T* root() const { return heap_.root(); }
+  T* next(const T* n) const { return heap_.next(n); }
+
+  // pushes least to greatest, so s pops the winners best first
+  template <class Q>
+  Q & drain_sorted(Q & s) {
+    while (!empty())
+      s.push(exhume());
+
+    assert(empty());
+    return s;
+  }
+
+  bounded_heap & forget() {
+    heap_.forget();
+    size_ = 0;
+    return *this;
+  }
+
+  stats_t stats() const { return heap_.stats(); }
+
+private:
+  heap_t heap_;
+  unsigned capacity_;
+  unsigned size_;
+};
+
 } // namespace lite
 
 #endif//LITE__HEAP_H
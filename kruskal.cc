@@ -3,8 +3,6 @@
 #include <cassert>
 
 #include <iostream>
-#include <sstream>
-#include <string>
 
 #include <algorithm>
 
@@ -12,7 +10,10 @@
 
 #include "set.h"
 #include "heap.h"
+#include "pool.h"
+#include "symbol.h"
 #include "table.h"
+#include "tokenizer.h"
 
 struct vertex_t;
 
@@ -32,24 +33,19 @@ struct edge_t {
         || link.bound()
         ;;
   }
-
-  void kill() { if (!bound()) delete this; }
 };
 
 struct vertex_t {
-  vertex_t(const char * c) : id(strdup(c)) { }
-  ~vertex_t() { free(const_cast<char*>(id)); }
+  vertex_t(const lite::symbol & c) : id(c) { }
 
-  const char* id;
+  lite::symbol id;
 
   lite::table_link<vertex_t> table_link;
-  typedef lite::table<vertex_t, &vertex_t::table_link, typeof(vertex_t::id), &vertex_t::id> table_t;
-
-  lite::set_link<vertex_t> set_link;
-  typedef lite::set<vertex_t, &vertex_t::set_link> set_t;
+  typedef lite::table<vertex_t, &vertex_t::table_link, typeof(vertex_t::id), &vertex_t::id,
+                      lite::symbol::compare, lite::symbol::hash> table_t;
 
-  bool typed() const { return set_t::typed(this); }
-  set_t* archetype() const { return set_t::archetype(this); }
+  lite::forest_link<vertex_t> set_link;
+  typedef lite::forest<vertex_t, &vertex_t::set_link> set_t;
 
   bool
   bound() const {
@@ -59,27 +55,7 @@ struct vertex_t {
         ;;
   }
 
-  void kill() { if (!bound()) delete this; }
-
-  bool unify(vertex_t* that) {
-    if (this == that)
-      return false;
-    else if (!typed() && !that->typed())
-      (new set_t)->join(this).join(that);
-    else if (!typed())
-      set_t::archetype(that)->join(this);
-    else if (!that->typed())
-      set_t::archetype(this)->join(that);
-    else {
-      set_t* this_a = set_t::archetype(this);
-      set_t* that_a = set_t::archetype(that);
-      if (this_a == that_a)
-        return false;
-      delete this_a->conjoin(that_a);
-    }
-
-    return true;
-  }
+  bool unify(vertex_t* that) { return set_t::join(this, that); }
 };
 
 int
@@ -87,53 +63,54 @@ main(int, char* argv[]) {
   const unsigned load = 2;
   unsigned n_vertices = 0;
 
+  lite::pool<edge_t> edge_pool;
+  lite::pool<vertex_t> vertex_pool;
   edge_t::heap_t edges;
+  lite::tokenizer input;
   vertex_t::table_t vertices;
 
-  std::string line;
-  while (std::getline(std::cin, line)) {
-    if (line.empty() || '#' == line[0])
+  while (input.line()) {
+    const char* token = input.token();
+    if (!token || '#' == *token)
+      continue;
+    const lite::symbol from(token);
+
+    if (!(token = input.token()))
       continue;
+    const lite::symbol to(token);
 
-    std::stringstream ss(line);
-    std::string from, to;
-    unsigned cost = 1;
-    ss >> from >> to >> cost;
+    token = input.token();
+    unsigned cost = token ? strtoul(token, NULL, 10) : 1;
 
-    vertex_t* f = vertices.get(from.c_str());
+    vertex_t* f = vertices.get(from);
     if (!f) {
       ++n_vertices;
       if (vertices.buckets() < load * n_vertices)
         vertices.reseat((load+1) * (n_vertices+1));
-      vertices.set(f = new vertex_t(from.c_str()));
+      vertices.set(f = new (vertex_pool.allocate()) vertex_t(from));
     }
 
-    vertex_t* t = vertices.get(to.c_str());
+    vertex_t* t = vertices.get(to);
     if (!t) {
       ++n_vertices;
       if (vertices.buckets() < load * n_vertices)
         vertices.reseat((load+1) * (n_vertices+1));
-      vertices.set(t = new vertex_t(to.c_str()));
+      vertices.set(t = new (vertex_pool.allocate()) vertex_t(to));
     }
 
-    edges.inhume(new edge_t(f, t, cost));
+    edges.inhume(new (edge_pool.allocate()) edge_t(f, t, cost));
   }
 
   while (!edges.empty()) {
     edge_t* e = edges.exhume();
     if (e->from->unify(e->to))
       std::cout
-        << e->from->id << " "
-        << e->to->id << " "
+        << e->from->id.text << " "
+        << e->to->id.text << " "
         << e->cost << std::endl;
-    delete e;
   }
 
-  for (vertex_t* v = vertices.iterator() ; v ;
-       v = vertices.wipe(v, &vertex_t::kill)) {
-    if (v->typed())
-      delete &v->archetype()->dissolve();
-  }
+  vertices.forget();
 
   vertices.reseat();
   return EXIT_SUCCESS;
@@ -104,6 +104,9 @@ public:
     return head;
   }
 
+  // empties the list without delisting, leaving the nodes' links stale
+  list & forget() { head = NULL; return *this; }
+
 private:
   T * head;
 };
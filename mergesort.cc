@@ -1,5 +1,7 @@
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <thread>
 
 #include <unistd.h>
 
@@ -17,8 +19,14 @@ struct node {
   typedef queue_t::sorter<typeof(value), &node::value> sorter_t;
 };
 
+// usage: mergesort [natural]
+//
+// sorts on every available core, or given natural, on one core by merging
+// the runs already present in the input, which suits nearly sorted data
 int
-main(int, char*[]) {
+main(int argc, char* argv[]) {
+  const bool natural = argc > 1 && !strcmp(argv[1], "natural");
+
   lace::haystack h;
   node::queue_t queue;
 
@@ -29,7 +37,10 @@ main(int, char*[]) {
       queue.enqueue(new (h.allocate<node>()) node(i));
   }
 
-  node::sorter_t::sort(queue);
+  if (natural)
+    node::sorter_t::natural_sort(queue);
+  else
+    node::sorter_t::sort(queue, std::thread::hardware_concurrency());
 
   while (!queue.empty()) {
     node* x = queue.dequeue();
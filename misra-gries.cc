@@ -24,19 +24,18 @@ struct node {
   void kill() { if (!bound()) delete this; }
 
   typedef lite::table<node, &node::table_link, typeof(node::value), &node::value> table_t;
-  typedef lite::heap<node, &node::heap_link, typeof(node::weight), &node::weight> heap_t;
+  typedef lite::bounded_heap<node, &node::heap_link, typeof(node::weight), &node::weight> heap_t;
 };
 
 int
 main(int, char*[]) {
   const unsigned k = 100;
 
-  node::heap_t heap;
+  node::heap_t heap(k);
 
   node::table_t::bucket_t buckets[k];
   node::table_t table(buckets, sizeof(buckets)/sizeof(*buckets));
 
-  unsigned entries = 0;
   unsigned count = 0;
   unsigned waterline = 0;
   while (std::cin) {
@@ -49,25 +48,20 @@ main(int, char*[]) {
     if (node* x = table.get(i)) {
       x->weight += weight;
       heap.bury(x);
-    } else if (entries < k) {
-      ++entries;
+      continue;
+    }
+
+    if (heap.full()) {
+      waterline += weight;
+      while (!heap.empty() && heap.root()->weight <= waterline)
+        table.bus(heap.exhume())->kill();
+    }
+
+    if (!heap.full()) {
       node* x = new node(i);
       x->weight = waterline + weight;
       table.set(x);
       heap.inhume(x);
-    } else {
-      waterline += weight;
-      while (!heap.empty() && heap.root()->weight <= waterline) {
-        --entries;
-        table.bus(heap.exhume())->kill();
-      }
-      if (entries < k) {
-        ++entries;
-        node* x = new node(i);
-        x->weight = waterline + weight;
-        table.set(x);
-        heap.inhume(x);
-      }
     }
 
   }
@@ -0,0 +1,64 @@
+#ifndef LITE__ORDER_H
+#define LITE__ORDER_H
+
+#include <lace/compare.h>
+
+#include <functional>
+#include <type_traits>
+
+namespace lite {
+
+// adapts a std::less-style functor, answering whether foo goes before bar,
+// to the three-way comparator that the containers take
+template <typename K, class F = std::less<K> >
+lace::compare_t
+functor_compare(K const & foo, K const & bar) {
+  F f;
+  return f(bar, foo) - f(foo, bar);
+}
+
+// the comparisons containers ask of C, which in general cost a call & a
+// test of its three-way result
+template <typename K, lace::compare_t (*C)(K const &, K const &),
+          bool = std::is_arithmetic<K>::value>
+struct order {
+  static bool forward() { return false; }
+  static bool backward() { return false; }
+  static bool natural() { return false; }
+
+  static bool less(K const & foo, K const & bar) { return C(foo, bar) < 0; }
+  static bool equal(K const & foo, K const & bar) { return 0 == C(foo, bar); }
+};
+
+// arithmetic keys under lace::compare, lace::reverse_compare, or either
+// std functor are compared with the builtin operators instead, which the
+// compiler can fold into flags & conditional moves; the tests on C are
+// constant, so each instance keeps only one path
+template <typename K, lace::compare_t (*C)(K const &, K const &)>
+struct order<K, C, true> {
+  typedef order<K, C, false> call_t;
+
+  static bool forward() {
+    return C == lace::compare<K> || C == functor_compare<K, std::less<K> >;
+  }
+
+  static bool backward() {
+    return C == lace::reverse_compare<K> || C == functor_compare<K, std::greater<K> >;
+  }
+
+  static bool natural() { return forward() || backward(); }
+
+  static bool less(K const & foo, K const & bar) {
+    return forward() ? foo < bar
+         : backward() ? bar < foo
+         : call_t::less(foo, bar);
+  }
+
+  static bool equal(K const & foo, K const & bar) {
+    return natural() ? !(foo < bar) && !(bar < foo) : call_t::equal(foo, bar);
+  }
+};
+
+} // namespace lite
+
+#endif//LITE__ORDER_H
@@ -0,0 +1,39 @@
+#!/bin/bash
+#
+# usage: perf.sh json generate kind n program [args...]
+#
+# generates an input of the given kind & size, times program reading it
+# on std::cin (or, after --args, taking it as arguments), & records the
+# result in json
+
+set -o pipefail
+
+json=$1 generate=$2 kind=$3 n=$4
+shift 4
+
+args=false
+if [ "$1" = --args ]; then
+	args=true
+	shift
+fi
+
+input=$(mktemp) || exit 1
+trap 'rm -f "$input"' EXIT
+
+"$generate" "$kind" "$n" > "$input" || exit 1
+
+start=$(date +%s%N)
+if $args; then
+	"$@" $(cat "$input") > /dev/null || exit 1
+else
+	"$@" < "$input" > /dev/null || exit 1
+fi
+end=$(date +%s%N)
+
+mkdir -p "$(dirname "$json")" || exit 1
+awk -v program="$(basename "$1")" -v kind="$kind" -v n="$n" \
+	-v lines="$(wc -l < "$input")" -v ns=$((end - start)) '
+	BEGIN {
+		printf "{ \"program\": \"%s\", \"input\": \"%s\", \"n\": %d, \"lines\": %d, \"seconds\": %.6f, \"lines_per_second\": %.0f }\n",
+			program, kind, n, lines, ns / 1e9, lines / (ns / 1e9)
+	}' > "$json"
@@ -0,0 +1,85 @@
+#ifndef LITE__POOL_H
+#define LITE__POOL_H
+
+#include <lace/do_not_copy.h>
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+namespace lite {
+
+// typed slab allocator; nodes are handed out as raw storage, to be
+// constructed by placement new, & are never destroyed individually, but
+// released together with their slabs when the pool is dropped
+template <class T>
+class pool : public lace::do_not_copy {
+public:
+  pool() : slabs_(NULL), cursor_(NULL), limit_(NULL), count_(0) { }
+  ~pool() { drop(); }
+
+  T* allocate() {
+    if (cursor_ == limit_)
+      grow();
+
+    assert(cursor_ < limit_);
+    ++count_;
+    return reinterpret_cast<T*>(cursor_++);
+  }
+
+  size_t size() const { return count_; }
+
+  // releases every slab without running any destructor, so the nodes
+  // must first have been forgotten by every container holding them
+  pool & drop() {
+    while (slab* s = slabs_) {
+      slabs_ = s->next;
+      operator delete(s);
+    }
+
+    cursor_ = limit_ = NULL;
+    count_ = 0;
+    return *this;
+  }
+
+private:
+  struct cell {
+    alignas(T) char storage[sizeof(T)];
+  };
+
+  struct slab {
+    slab* next;
+    size_t cells;
+    cell* begin() { return reinterpret_cast<cell*>(this + 1); }
+  };
+
+  static const size_t first = 64;
+  static const size_t most = 1 << 16;
+
+  slab* slabs_;
+  cell* cursor_;
+  cell* limit_;
+  size_t count_;
+
+  // slabs double until they reach most cells
+  void grow() {
+    size_t cells = slabs_ ? slabs_->cells * 2 : first;
+    if (cells > most)
+      cells = most;
+
+    static_assert(!(sizeof(slab) % alignof(cell)) && alignof(cell) <= alignof(std::max_align_t),
+                  "cells would be misaligned after the slab header");
+
+    slab* s = static_cast<slab*>(operator new(sizeof(slab) + cells * sizeof(cell)));
+    s->next = slabs_;
+    s->cells = cells;
+    slabs_ = s;
+
+    cursor_ = s->begin();
+    limit_ = cursor_ + cells;
+  }
+};
+
+} // namespace lite
+
+#endif//LITE__POOL_H
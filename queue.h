@@ -3,11 +3,15 @@
 
 #include <lace/do_not_copy.h>
 #include "link.h"
+#include "order.h"
 
 #include <lace/compare.h>
 
 #include <cassert>
 #include <cstddef>
+#include <climits>
+#include <thread>
+#include <type_traits>
 
 namespace lite {
 
@@ -81,12 +85,17 @@ public:
       return C(foo->*key, bar->*key);
     }
 
+    static
+    bool before(const T* foo, const T* bar) {
+      return order<K, C>::less(foo->*key, bar->*key);
+    }
+
     static
     bool sorted(const queue & q) {
       if (!q.empty())
         for (T* i = q.peek() ; i ; i = q.next(i))
           if (T* n = q.next(i))
-            if (compare(i, n) > 0)
+            if (before(n, i))
               return false;
 
       return true;
@@ -100,11 +109,12 @@ public:
       assert(sorted(foo));
       assert(sorted(bar));
 
-      while (!foo.empty() && !bar.empty())
-        if (compare(foo.peek(), bar.peek()) <= 0)
-          q.chain(foo, 1);
-        else
-          q.chain(bar, 1);
+      // ties go to foo, for stability; selecting the queue rather than
+      // branching lets arithmetic keys merge by conditional move
+      while (!foo.empty() && !bar.empty()) {
+        queue & from = before(bar.peek(), foo.peek()) ? bar : foo;
+        q.chain(from, from.peek(), 1);
+      }
 
       if (!foo.empty())
         q.chain(foo);
@@ -119,43 +129,269 @@ public:
 
     static
     queue & sort(queue & q) {
-      for (unsigned stride = 1 ; q.size() > stride ; stride *= 2) {
+      // binary counter of runs; bin i is empty or holds 2^i nodes
+      queue bins[CHAR_BIT * sizeof(unsigned) + 1];
+      unsigned fill = 0;
+
+      while (!q.empty()) {
+        queue carry;
+        carry.chain(q, q.peek(), 1);
+
+        unsigned i = 0;
+        for ( ; i < fill && !bins[i].empty() ; ++i) {
+          queue that;
+          merge(that, bins[i], carry);
+          carry.chain(that);
+        }
+
+        assert(bins[i].empty());
+        bins[i].chain(carry);
+        if (i == fill)
+          ++fill;
+      }
+
+      // older runs live in higher bins, so they go first to stay stable
+      for (unsigned i = 0 ; i < fill ; ++i) {
+        if (bins[i].empty())
+          continue;
+
         queue that;
-        while (q.size() > stride) {
-          queue foo, bar;
+        merge(that, bins[i], q);
+        q.chain(that);
+      }
+
+      assert(sorted(q));
+      return q;
+    }
 
-          assert(!q.empty());
-          foo.chain(q, stride);
-          assert(!foo.empty());
-          assert(sorted(foo));
+    static
+    queue & sort(queue & q, unsigned threads) {
+      if (threads < 2 || q.size() < 2 * grain)
+        return sort(q);
 
-          assert(!q.empty());
-          bar.chain(q, stride);
-          assert(!bar.empty());
-          assert(sorted(bar));
+      queue foo;
+      foo.chain(q, q.size() / 2);
 
-          merge(that, foo, bar);
-          assert(!that.empty());
-        }
+      std::thread t(sort_in, &foo, threads / 2);
+      sort(q, threads - threads / 2);
+      t.join();
 
-        if (!q.empty()) {
-          assert(sorted(q));
-          that.chain(q);
-        }
+      queue that;
+      merge(that, foo, q);
+      q.chain(that);
 
-        assert(!that.empty());
-        q.chain(that);
+      assert(sorted(q));
+      return q;
+    }
+
+    static
+    queue & natural_sort(queue & q) {
+      queue runs[depth];
+      unsigned n = 0;
+
+      while (!q.empty()) {
+        assert(n < depth);
+        take_run(runs[n++], q);
+        assert(sorted(runs[n-1]));
+
+        // keep each run longer than the sum of the next two
+        while (n > 1) {
+          unsigned i = n - 2;
+          if ((i > 0 && runs[i-1].size() <= runs[i].size() + runs[i+1].size())
+           || (i > 1 && runs[i-2].size() <= runs[i-1].size() + runs[i].size())) {
+            if (runs[i-1].size() < runs[i+1].size())
+              --i;
+          } else if (runs[i].size() > runs[i+1].size()) {
+            break;
+          }
+          merge_at(runs, i, n);
+          --n;
+        }
       }
 
+      for ( ; n > 1 ; --n)
+        merge_at(runs, n - 2, n);
+
+      if (n)
+        q.chain(runs[0]);
+
       assert(sorted(q));
       return q;
     }
 
+  private:
+    static const unsigned grain = 4096;
+    static const unsigned block = 32;
+    static const unsigned depth = 2 * CHAR_BIT * sizeof(unsigned);
+
+    static void take_run(queue & run, queue & q) {
+      assert(run.empty());
+      assert(!q.empty());
+
+      T* i = q.peek();
+      T* n = q.next(i);
+      unsigned length = 1;
+
+      if (n && before(n, i)) {
+        // strictly descending, so reversal is stable
+        do {
+          i = n;
+          ++length;
+        } while ((n = q.next(i)) && before(n, i));
+
+        run.chain(q, i, length).reverse();
+      } else {
+        while (n && !before(n, i)) {
+          i = n;
+          ++length;
+          n = q.next(i);
+        }
+
+        run.chain(q, i, length);
+      }
+
+      // sort short runs up to a block while they are still in cache
+      if (run.size() < block && !q.empty()) {
+        run.chain(q, block - run.size());
+        sort(run);
+      }
+    }
+
+    static void merge_at(queue runs[], unsigned i, unsigned n) {
+      assert(i + 1 < n);
+
+      queue that;
+      merge(that, runs[i], runs[i+1]);
+      runs[i].chain(that);
+
+      if (i + 2 < n)
+        runs[i+1].chain(runs[i+2]);
+    }
+
+    static void sort_in(queue * q, unsigned threads) { sort(*q, threads); }
+
   }; // sorter
 
   template <typename K, K T::*key>
   struct reverse_sorter : public sorter<K, key, lace::reverse_compare<K> > { };
 
+  template <typename K, K T::*key>
+  struct radix_sorter {
+
+    static
+    queue & sort(queue & q) {
+      return sort(q, static_cast<K*>(NULL));
+    }
+
+  private:
+    static const unsigned radix = 1 << CHAR_BIT;
+    static const unsigned block = 32;
+
+    // least significant digit first, for fixed-width integers
+    template <typename I>
+    static
+    queue & sort(queue & q, I*) {
+      static_assert(std::is_integral<I>::value, "radix_sorter requires integer or string keys");
+      typedef typename std::make_unsigned<I>::type U;
+
+      if (q.empty())
+        return q;
+
+      // skip digits on which every key agrees
+      const U first = digits<U>(q.peek());
+      U differ = 0;
+      for (T* i = q.peek() ; i ; i = q.next(i))
+        differ |= digits<U>(i) ^ first;
+
+      queue buckets[radix];
+      for (unsigned shift = 0 ; shift < CHAR_BIT * sizeof(U) ; shift += CHAR_BIT) {
+        if (!((differ >> shift) & (radix - 1)))
+          continue;
+
+        while (!q.empty()) {
+          T* t = q.dequeue();
+          buckets[(digits<U>(t) >> shift) & (radix - 1)].enqueue(t);
+        }
+
+        for (unsigned i = 0 ; i < radix ; ++i)
+          if (!buckets[i].empty())
+            q.chain(buckets[i]);
+      }
+
+      return q;
+    }
+
+    // most significant digit first, for nul-terminated strings
+    static
+    queue & sort(queue & q, const char**) {
+      return msd(q, 0);
+    }
+
+    // the largest bucket is sorted by the loop rather than by recursion,
+    // so each call is on at most half its caller's nodes & the stack is
+    // logarithmic even when every level peels off a single key; buckets
+    // ordered before it are sorted out in front, & those after it are
+    // pushed onto the front of the rest
+    static
+    queue & msd(queue & q, size_t depth) {
+      queue out, rest;
+      queue buckets[radix];
+
+      while (q.size() >= block) {
+        while (!q.empty()) {
+          T* t = q.dequeue();
+          buckets[(unsigned char)(t->*key)[depth]].enqueue(t);
+        }
+
+        unsigned c = 1;
+        for (unsigned i = 2 ; i < radix ; ++i)
+          if (buckets[i].size() > buckets[c].size())
+            c = i;
+
+        if (!buckets[0].empty())
+          out.chain(buckets[0]);
+
+        for (unsigned i = 1 ; i < c ; ++i)
+          if (!buckets[i].empty())
+            out.chain(msd(buckets[i], depth + 1));
+
+        queue after;
+        for (unsigned i = c + 1 ; i < radix ; ++i)
+          if (!buckets[i].empty())
+            after.chain(msd(buckets[i], depth + 1));
+
+        if (!rest.empty())
+          after.chain(rest);
+        if (!after.empty())
+          rest.chain(after);
+
+        if (buckets[c].empty())
+          break;
+
+        q.chain(buckets[c]);
+        ++depth;
+      }
+
+      if (!q.empty())
+        out.chain(sorter<K, key>::sort(q));
+      if (!rest.empty())
+        out.chain(rest);
+      if (!out.empty())
+        q.chain(out);
+
+      return q;
+    }
+
+    template <typename U>
+    static U digits(const T* t) {
+      static const U sign = std::is_signed<K>::value
+                          ? U(1) << (CHAR_BIT * sizeof(U) - 1)
+                          : U(0);
+      return U(t->*key) ^ sign;
+    }
+
+  }; // radix_sorter
+
   queue & reverse() {
     if (empty())
       return *this;
@@ -200,6 +436,26 @@ public:
     return *this;
   }
 
+  queue & chain(queue & that, T* last, unsigned n) {
+    assert(this != &that);
+    assert(!that.empty());
+    assert(n && n <= that.size());
+
+    if (last == *that.tail)
+      return chain(that);
+
+    *tail = that.head;
+    tail = &(last->*L).p;
+
+    that.head = *tail;
+    *tail = last;
+
+    nodes += n;
+    that.nodes -= n;
+
+    return *this;
+  }
+
   queue & chain(queue & that) {
     assert(this != &that);
     assert(!that.empty());
@@ -225,6 +481,14 @@ public:
 
   unsigned size() const { return nodes; }
 
+  // empties the queue without dequeuing, leaving the nodes' links stale
+  queue & forget() {
+    head = NULL;
+    tail = &head;
+    nodes = 0;
+    return *this;
+  }
+
 private:
   T * head;
   T ** tail;
@@ -7,6 +7,7 @@
 #include <cassert>
 #include <cstddef>
 #include <algorithm>
+#include <atomic>
 
 namespace lite {
 
@@ -134,6 +135,14 @@ public:
     return (t->*L).n.qualified(t != *tail);
   }
 
+  // empties the set without dissolving, leaving the members' links stale
+  set & forget() {
+    head = NULL;
+    tail = &head;
+    rank = 0;
+    return *this;
+  }
+
 private:
   T * head;
   T ** tail;
@@ -141,6 +150,194 @@ private:
   unsigned rank;
 };
 
+template <class X>
+struct forest_link {
+  typedef forest_link type;
+  template <class T, typename forest_link<T>::type T::*L>
+    friend class forest;
+
+  forest_link() : rank(0) { }
+
+  bool bound() const {
+    assert(p.p || !n.p);
+    return p.p;
+  }
+
+private:
+  link<X> p, n;
+  unsigned rank;
+};
+
+template <class T, typename forest_link<T>::type T::*L>
+class forest {
+public:
+  static bool typed(const T* t) { return (t->*L).bound(); }
+
+  static T* archetype(T* t) {
+    if (!typed(t))
+      return t;
+
+    while (!is_root(t)) {
+      T* g = parent(parent(t)); // halve path
+      (t->*L).p.p = g;
+      t = g;
+    }
+
+    return t;
+  }
+
+  static bool contains(T* t, T* u) {
+    return t == u || (typed(t) && typed(u) && archetype(t) == archetype(u));
+  }
+
+  static T* join(T* t, T* u) {
+    T* a = archetype(bind(t));
+    T* b = archetype(bind(u));
+
+    if (a == b)
+      return NULL;
+
+    // union by rank
+    if ((a->*L).rank < (b->*L).rank)
+      std::swap(a, b);
+    else if ((a->*L).rank == (b->*L).rank)
+      ++(a->*L).rank;
+
+    (b->*L).p.p = a;
+
+    // splice member rings
+    std::swap((a->*L).n.p, (b->*L).n.p);
+
+    assert(is_root(a));
+    assert(archetype(t) == archetype(u));
+    return a;
+  }
+
+  typedef void (T::*dissolver_t)();
+
+  static void dissolve(T* t, const dissolver_t d = NULL) {
+    if (!typed(t)) {
+      if (d)
+        (t->*d)();
+      return;
+    }
+
+    T* i = t;
+    do {
+      T* n = (i->*L).n.p;
+      (i->*L).p.p = NULL;
+      (i->*L).n.p = NULL;
+      (i->*L).rank = 0;
+      assert(!typed(i));
+      if (d)
+        (i->*d)();
+      i = n;
+    } while (i != t);
+  }
+
+  static T* next(const T* start, const T* t) {
+    return (t->*L).n.guarded(start);
+  }
+
+private:
+  static T* parent(const T* t) { assert(typed(t)); return (t->*L).p.p; }
+  static bool is_root(const T* t) { return t == parent(t); }
+
+  static T* bind(T* t) {
+    if (!typed(t)) {
+      (t->*L).p.p = t;
+      (t->*L).n.p = t;
+      (t->*L).rank = 0;
+    }
+    return t;
+  }
+};
+
+template <class X>
+struct atomic_forest_link {
+  typedef atomic_forest_link type;
+  template <class T, typename atomic_forest_link<T>::type T::*L>
+    friend class atomic_forest;
+
+  atomic_forest_link() : p(NULL) { }
+  ~atomic_forest_link() { assert(!bound()); }
+
+  bool bound() const { return p.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<X*> p;
+};
+
+template <class T, typename atomic_forest_link<T>::type T::*L>
+class atomic_forest {
+public:
+  static bool typed(const T* t) { return (t->*L).bound(); }
+
+  // parents only ever move toward the root, so losing a race to halve
+  // the path merely forgoes a shortcut
+  static T* archetype(T* t) {
+    T* p = bind(t);
+    while (true) {
+      T* g = parent(p);
+      if (p == g)
+        return p;
+
+      (t->*L).p.compare_exchange_weak(p, g, std::memory_order_relaxed);
+      t = g;
+      p = parent(t);
+    }
+  }
+
+  static bool contains(T* t, T* u) {
+    while (true) {
+      T* a = archetype(t);
+      T* b = archetype(u);
+      if (a == b)
+        return true;
+      if (a == parent(a)) // a was still a root after b was found
+        return false;
+    }
+  }
+
+  // links the lower root beneath the higher, which rules out cycles
+  static bool join(T* t, T* u) {
+    while (true) {
+      T* a = archetype(t);
+      T* b = archetype(u);
+
+      if (a == b)
+        return false;
+
+      if (intptr_t(a) < intptr_t(b))
+        std::swap(a, b);
+
+      T* r = b;
+      if ((b->*L).p.compare_exchange_strong(r, a, std::memory_order_acq_rel))
+        return true;
+    }
+  }
+
+  // only once no other thread can reach the forest, for every member
+  static void dissolve(T* t) {
+    (t->*L).p.store(NULL, std::memory_order_relaxed);
+    assert(!typed(t));
+  }
+
+private:
+  static T* parent(const T* t) {
+    T* p = (t->*L).p.load(std::memory_order_acquire);
+    assert(p);
+    return p;
+  }
+
+  static T* bind(T* t) {
+    T* p = (t->*L).p.load(std::memory_order_acquire);
+    if (!p && (t->*L).p.compare_exchange_strong(p, t, std::memory_order_acq_rel))
+      return t;
+    return p;
+  }
+};
+
 } // namespace lite
 
 #endif//LITE__SET_H
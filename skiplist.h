@@ -0,0 +1,232 @@
+#ifndef LITE__SKIPLIST_H
+#define LITE__SKIPLIST_H
+
+#include <lace/do_not_copy.h>
+#include "order.h"
+
+#include <lace/compare.h>
+
+#include <cassert>
+#include <cstddef>
+#include <stdint.h>
+#include <atomic>
+
+namespace lite {
+
+template <class X>
+class skiplist_link {
+public:
+  typedef skiplist_link type;
+  template <class T, typename skiplist_link<T>::type T::*L,
+            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &)>
+    friend class skiplist;
+
+  // a quarter of the nodes reach each level above the last, so twelve
+  // levels keep searches logarithmic up to about 16 million nodes
+  static const unsigned levels = 12;
+
+  skiplist_link() : height(0) {
+    for (unsigned i = 0 ; i < levels ; ++i)
+      next[i].store(NULL, std::memory_order_relaxed);
+  }
+
+  ~skiplist_link() { assert(!bound()); }
+
+  bool bound() const { return height; }
+
+private:
+  std::atomic<X*> next[levels];
+  unsigned char height;
+};
+
+// skip list whose towers live in the nodes; any number of threads may
+// insert & search at once without locking, since a node is published at
+// the bottom level before any shortcut to it, & nothing is ever unlinked
+// while they run; erase, fell & forget exclude other writers, though not
+// readers, so an erased node must outlive any search that might be on it
+template <class T, typename skiplist_link<T>::type T::*L,
+          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &) = lace::compare<K> >
+class skiplist : public lace::do_not_copy {
+public:
+  typedef skiplist_link<T> link_t;
+  static const unsigned levels = link_t::levels;
+
+  skiplist() : size_(0) {
+    for (unsigned i = 0 ; i < levels ; ++i)
+      head_[i].store(NULL, std::memory_order_relaxed);
+  }
+
+  ~skiplist() { assert(empty()); }
+
+  bool empty() const { return !first(); }
+
+  // exact once writers have finished
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  static
+  lace::compare_t compare(const T* foo, const T* bar) {
+    return C(foo->*key, bar->*key);
+  }
+
+  // equal keys are kept in the order they were inserted
+  skiplist & insert(T* t) {
+    assert(!is_bound(t));
+
+    const unsigned h = height(t);
+    (t->*L).height = h;
+
+    std::atomic<T*>* prev[levels];
+    T* succ[levels];
+    locate(t->*key, prev, succ);
+
+    for (unsigned i = 0 ; i < h ; ++i) {
+      while (true) {
+        (t->*L).next[i].store(succ[i], std::memory_order_relaxed);
+        if (prev[i]->compare_exchange_weak(succ[i], t,
+                                           std::memory_order_release,
+                                           std::memory_order_acquire))
+          break;
+
+        // another node went in here first, so walk on past it
+        while (succ[i] && !before(t->*key, succ[i])) {
+          prev[i] = &(succ[i]->*L).next[i];
+          succ[i] = prev[i]->load(std::memory_order_acquire);
+        }
+      }
+    }
+
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return *this;
+  }
+
+  // leaves t's tower intact, so that searches standing on it can go on
+  T* erase(T* t) {
+    assert(is_bound(t));
+
+    const K & k = t->*key;
+    const unsigned h = (t->*L).height;
+
+    T* p = NULL;
+    for (unsigned i = levels ; i-- > 0 ; ) {
+      T* n = slot(p, i).load(std::memory_order_relaxed);
+      while (n && after(k, n)) {
+        p = n;
+        n = slot(p, i).load(std::memory_order_relaxed);
+      }
+
+      if (i >= h)
+        continue;
+
+      // past any equal keys, which need not be in the same order on
+      // every level when they were inserted concurrently
+      std::atomic<T*>* s = &slot(p, i);
+      while ((n = s->load(std::memory_order_relaxed)) != t) {
+        assert(n && !before(k, n));
+        s = &(n->*L).next[i];
+      }
+      s->store((t->*L).next[i].load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    (t->*L).height = 0;
+    size_.fetch_sub(1, std::memory_order_relaxed);
+
+    return t;
+  }
+
+  T* first() const { return head_[0].load(std::memory_order_acquire); }
+
+  T* next(const T* t) const {
+    return (t->*L).next[0].load(std::memory_order_acquire);
+  }
+
+  // the first node not ordered before k
+  T* lower_bound(const K & k) const {
+    const std::atomic<T*>* s = &head_[levels - 1];
+    T* n = NULL;
+    for (unsigned i = levels ; i-- > 0 ; ) {
+      n = s->load(std::memory_order_acquire);
+      while (n && after(k, n)) {
+        s = &(n->*L).next[i];
+        n = s->load(std::memory_order_acquire);
+      }
+      if (i)
+        s = s - 1; // the same tower, one level down
+    }
+    return n;
+  }
+
+  // the first node inserted with key k
+  T* find(const K & k) const {
+    T* n = lower_bound(k);
+    return n && !before(k, n) ? n : NULL;
+  }
+
+  typedef void (T::*axe_t)();
+
+  skiplist & fell(const axe_t a = NULL) {
+    T* n = first();
+    forget();
+    while (n) {
+      T* x = n;
+      n = next(x);
+      (x->*L).height = 0;
+      if (a)
+        (x->*a)();
+    }
+
+    assert(empty());
+    return *this;
+  }
+
+  // empties the list without erasing, leaving the nodes' links stale
+  skiplist & forget() {
+    for (unsigned i = 0 ; i < levels ; ++i)
+      head_[i].store(NULL, std::memory_order_release);
+    size_.store(0, std::memory_order_relaxed);
+    return *this;
+  }
+
+private:
+  typedef order<K, C> order_t;
+
+  std::atomic<T*> head_[levels];
+  std::atomic<size_t> size_;
+
+  static bool is_bound(const T* t) { assert(t); return (t->*L).bound(); }
+
+  static bool before(const K & k, const T* t) { return order_t::less(k, t->*key); }
+  static bool after(const K & k, const T* t) { return order_t::less(t->*key, k); }
+
+  std::atomic<T*> & slot(T* p, unsigned i) {
+    return p ? (p->*L).next[i] : head_[i];
+  }
+
+  // heights are drawn from the node's address, so inserting threads share
+  // no generator; a quarter as many nodes reach each level as the last
+  static unsigned height(const T* t) {
+    uint32_t bits = (uint64_t(uintptr_t(t)) * 0x9e3779b97f4a7c15ull) >> 32;
+    unsigned h = 1 + __builtin_ctz(bits | 1u << (2 * (levels - 1))) / 2;
+    assert(h >= 1 && h <= levels);
+    return h;
+  }
+
+  // finds, at each level, the last link to a node not ordered after k
+  void locate(const K & k, std::atomic<T*>* prev[], T* succ[]) {
+    std::atomic<T*>* s = &head_[levels - 1];
+    for (unsigned i = levels ; i-- > 0 ; ) {
+      T* n = s->load(std::memory_order_acquire);
+      while (n && !before(k, n)) {
+        s = &(n->*L).next[i];
+        n = s->load(std::memory_order_acquire);
+      }
+      prev[i] = s;
+      succ[i] = n;
+      if (i)
+        s = s - 1; // the same tower, one level down
+    }
+  }
+};
+
+} // namespace lite
+
+#endif//LITE__SKIPLIST_H
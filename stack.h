@@ -62,6 +62,10 @@ public:
     return (t->*L).guarded(sentinel());
   }
 
+  // empties the stack without popping; the nodes keep stale links, so
+  // this is only for nodes that are about to be released in bulk
+  stack & forget() { head = const_cast<T*>(sentinel()); return *this; }
+
 private:
   T * head;
   const T* sentinel() const { return reinterpret_cast<const T*>(&head); }
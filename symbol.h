@@ -0,0 +1,47 @@
+#ifndef LITE__SYMBOL_H
+#define LITE__SYMBOL_H
+
+#include <lace/hash.h>
+#include <lace/compare.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+namespace lite {
+
+// a string which does not own its characters, carrying its length and
+// hash so that table lookups & rehashes never rescan it; ordered by hash,
+// then length, then bytes, which is total but not lexicographic
+struct symbol {
+  const char* text;
+  size_t length;
+  lace::hash_t digest;
+
+  symbol() : text(NULL), length(0), digest(0) { }
+  explicit symbol(const char* s)
+    : text(s)
+    , length(strlen(s))
+    , digest(lace::hash(text))
+  { assert(text); }
+
+  static lace::compare_t compare(symbol const & foo, symbol const & bar) {
+    if (foo.digest != bar.digest)
+      return foo.digest < bar.digest ? -1 : 1;
+
+    if (foo.length != bar.length)
+      return foo.length < bar.length ? -1 : 1;
+
+    if (foo.text == bar.text)
+      return 0;
+
+    int c = memcmp(foo.text, bar.text, foo.length);
+    return c < 0 ? -1 : c > 0 ? 1 : 0;
+  }
+
+  static lace::hash_t hash(symbol const & s) { return s.digest; }
+};
+
+} // namespace lite
+
+#endif//LITE__SYMBOL_H
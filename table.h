@@ -3,6 +3,7 @@
 
 #include <lace/do_not_copy.h>
 #include "link.h"
+#include "order.h"
 
 #include <lace/hash.h>
 #include <lace/compare.h>
@@ -10,6 +11,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <algorithm>
 
 namespace lite {
@@ -19,7 +21,7 @@ struct table_link : private link<X> {
   typedef table_link type;
   template <class T, typename table_link<T>::type T::*L,
             typename K, K T::*key, lace::compare_t (*C)(K const &, K const &),
-            lace::hash_t (*H)(K const &)>
+            lace::hash_t (*H)(K const &), class S>
     friend class table;
 
   bool bound() const { return link<X>::p; }
@@ -29,20 +31,64 @@ template <class X>
 class table_bucket : private link<X> {
   template <class T, typename table_link<T>::type T::*L,
             typename K, K T::*key, lace::compare_t (*C)(K const &, K const &),
-            lace::hash_t (*H)(K const &)>
+            lace::hash_t (*H)(K const &), class S>
     friend class table;
 private:
   X* sentinel() { return reinterpret_cast<X*>(this); }
   const X* sentinel() const { return reinterpret_cast<const X*>(this); }
 };
 
+// the default statistics policy, which records nothing & costs nothing
+struct table_nostats {
+  struct snapshot_t { };
+
+  void got(size_t) const { }
+  void missed(size_t) const { }
+  void probed(size_t) const { }
+  void set() const { }
+  void bus() const { }
+  void rehashed() const { }
+
+  snapshot_t snapshot() const { return snapshot_t(); }
+};
+
+// counts operations, with histograms of the chain nodes walked by each get
+// & is_member; the last bin holds every longer walk
+struct table_stats {
+  static const unsigned bins = 16;
+
+  struct snapshot_t {
+    unsigned long long gets, hits, misses, sets, buses, rehashes;
+    unsigned long long get_walks[bins];
+    unsigned long long member_walks[bins];
+  };
+
+  table_stats() { memset(&counts_, 0, sizeof(counts_)); }
+
+  void got(size_t walked) const { ++counts_.gets; ++counts_.hits; ++counts_.get_walks[bin(walked)]; }
+  void missed(size_t walked) const { ++counts_.gets; ++counts_.misses; ++counts_.get_walks[bin(walked)]; }
+  void probed(size_t walked) const { ++counts_.member_walks[bin(walked)]; }
+  void set() const { ++counts_.sets; }
+  void bus() const { ++counts_.buses; }
+  void rehashed() const { ++counts_.rehashes; }
+
+  snapshot_t snapshot() const { return counts_; }
+
+private:
+  mutable snapshot_t counts_;
+
+  static unsigned bin(size_t walked) { return walked < bins ? walked : bins - 1; }
+};
+
 template <class T, typename table_link<T>::type T::*L,
           typename K, K T::*key,
           lace::compare_t (*C)(K const &, K const &) = lace::compare<K>,
-          lace::hash_t (*H)(K const &) = lace::hash<K> >
-class table : public lace::do_not_copy {
+          lace::hash_t (*H)(K const &) = lace::hash<K>,
+          class S = table_nostats>
+class table : public lace::do_not_copy, private S {
 public:
   typedef table_bucket<T> bucket_t;
+  typedef typename S::snapshot_t stats_t;
 
   table(bucket_t bs[] = NULL, const size_t n = 0)
     : buckets_(bs), n_buckets_(n), divider_(n)
@@ -88,6 +134,7 @@ public:
     set_buckets();
     give_all(ts);
 
+    S::rehashed();
     return bs;
   }
 
@@ -105,13 +152,14 @@ public:
     assert(is_bound(t));
     assert(!empty());
 
+    S::set();
     return *this;
   }
 
   T* bus(T* t) {
     assert(!empty());
     assert(is_bound(t));
-    assert(is_member(t));
+    assert(holds(t));
 
     bucket_t & b = buckets_[index(t)];
     assert(b.p);
@@ -122,9 +170,10 @@ public:
 
     take_next(c);
 
-    assert(!is_member(t));
+    assert(!holds(t));
     assert(!is_bound(t));
 
+    S::bus();
     return t;
   }
 
@@ -134,32 +183,35 @@ public:
     return *t;
   }
 
+  // a hit moves to the front of its chain, to be found sooner next time
   T* get(const K & k) const {
-    if (!n_buckets_)
+    bucket_t* b;
+    T ** c = seek(k, b);
+    if (!c)
       return NULL;
 
-    bucket_t & b = buckets_[index(k)];
-
-    for (T ** c = &b.p ; *c != b.sentinel() ; c = &((*c)->*L).p)
-      if (0 == C(k, (*c)->*key))
-          return c == &b.p ? *c : insert_at(&b.p, take_next(c));
+    return c == &b->p ? *c : insert_at(&b->p, take_next(c));
+  }
 
-    return NULL;
+  // as get, but leaves the chain in order, so that a hit writes nothing
+  T* find(const K & k) const {
+    bucket_t* b;
+    T ** c = seek(k, b);
+    return c ? *c : NULL;
   }
 
   bool is_member(const T* t) const {
     if (!n_buckets_ || !is_bound(t))
       return false;
 
-    bucket_t & b = buckets_[index(t)];
-
-    for (T ** c = &b.p ; *c != b.sentinel() ; c = &((*c)->*L).p)
-      if (t == *c)
-        return true;
-
-    return false;
+    size_t walked = 0;
+    const bool member = chained(t, walked);
+    S::probed(walked);
+    return member;
   }
 
+  stats_t stats() const { return S::snapshot(); }
+
   T* iterator() const {
     for (size_t i = 0 ; i < n_buckets_ ; ++i)
       if (buckets_[i].p != buckets_[i].sentinel())
@@ -169,7 +221,7 @@ public:
   }
 
   T* next(const T* t) const {
-    assert(is_member(t));
+    assert(holds(t));
 
     T* n = (t->*L).p;
 
@@ -200,6 +252,14 @@ public:
     return *this;
   }
 
+  // empties the table without bussing, resetting each bucket but never
+  // walking a chain; the nodes' links are left stale
+  table & forget() {
+    for (size_t i = 0 ; i < n_buckets_ ; ++i)
+      buckets_[i].p = buckets_[i].sentinel();
+    return *this;
+  }
+
 private:
   bucket_t * buckets_;
   size_t n_buckets_;
@@ -207,6 +267,49 @@ private:
 
   static bool is_bound(const T* n) { assert(n); return (n->*L).bound(); }
 
+  // as is_member, but unrecorded, so that assertions leave stats alone
+  bool holds(const T* t) const {
+    size_t walked = 0;
+    return n_buckets_ && is_bound(t) && chained(t, walked);
+  }
+
+  // the link pointing at the node keyed k, with b its bucket; NULL if
+  // there is none
+  T ** seek(const K & k, bucket_t *& b) const {
+    size_t walked = 0;
+
+    if (!n_buckets_) {
+      S::missed(walked);
+      return NULL;
+    }
+
+    b = &buckets_[index(k)];
+
+    for (T ** c = &b->p ; *c != b->sentinel() ; c = &((*c)->*L).p) {
+      ++walked;
+      if (order<K, C>::equal(k, (*c)->*key)) {
+        S::got(walked);
+        return c;
+      }
+    }
+
+    S::missed(walked);
+    return NULL;
+  }
+
+  bool chained(const T* t, size_t & walked) const {
+    assert(n_buckets_);
+
+    bucket_t & b = buckets_[index(t)];
+    for (T ** c = &b.p ; *c != b.sentinel() ; c = &((*c)->*L).p) {
+      ++walked;
+      if (t == *c)
+        return true;
+    }
+
+    return false;
+  }
+
   size_t modulo(lace::hash_t h) const { return divider_.modulo(h, n_buckets_); }
 
   size_t index(const K & k) const { return modulo(H(k)); }
@@ -263,8 +366,10 @@ private:
   void give_all(bucket_t & ts) {
     assert(ts.p);
 
-    while (ts.p != ts.sentinel())
-      set(take_next(&ts.p));
+    while (ts.p != ts.sentinel()) {
+      T* t = take_next(&ts.p);
+      insert_at(&buckets_[index(t)].p, t);
+    }
 
     assert(ts.p == ts.sentinel());
     ts.p = NULL;
@@ -3,92 +3,58 @@
 #include <cassert>
 
 #include <iostream>
-#include <sstream>
-#include <string>
+#include <vector>
 
 #include <algorithm>
 
 #include <unistd.h>
 
-#include "set.h"
-#include "heap.h"
+#include "graph.h"
+#include "pool.h"
 #include "table.h"
+#include "tokenizer.h"
 #include "stack.h"
+#include "symbol.h"
 
-struct vertex_t;
-
-struct edge_t {
-  edge_t(vertex_t* f, vertex_t* t) : from(f), to(t) { }
-
-  vertex_t* from;
-  vertex_t* to;
-
-  lite::stack_link<edge_t> from_link;
-  typedef lite::stack<edge_t, &edge_t::from_link> from_edges_t;
-
-  bool
-  bound() const {
-    return false
-        || from_link.bound()
-        ;;
-  }
-
-  void kill() { if (!bound()) delete this; }
-};
+typedef lite::graph<unsigned> graph_t;
 
 struct vertex_t {
-  vertex_t(const char * c) : id(strdup(c)), index(0), root(NULL), edge(NULL) { }
-  ~vertex_t() { free(const_cast<char*>(id)); }
-
-  const char* id;
+  vertex_t(const lite::symbol & c, graph_t::index_t i)
+    : id(c)
+    , slot(i)
+    , index(0)
+    , lowlink(0)
+    , arc(NULL)
+  { }
+
+  lite::symbol id;
+  graph_t::index_t slot;
   unsigned index;
-  vertex_t* root;
-  edge_t* edge;
-
-  edge_t::from_edges_t from_edges;
+  unsigned lowlink;
+  const graph_t::arc_t* arc;
 
   lite::table_link<vertex_t> table_link;
-  typedef lite::table<vertex_t, &vertex_t::table_link, typeof(vertex_t::id), &vertex_t::id> table_t;
+  typedef lite::table<vertex_t, &vertex_t::table_link, typeof(vertex_t::id), &vertex_t::id,
+                      lite::symbol::compare, lite::symbol::hash> table_t;
 
+  // the depth-first path being explored
+  lite::stack_link<vertex_t> path_link;
+  typedef lite::stack<vertex_t, &vertex_t::path_link> path_t;
+
+  // visited vertices not yet assigned a component
   lite::stack_link<vertex_t> stack_link;
   typedef lite::stack<vertex_t, &vertex_t::stack_link> stack_t;
 
-  lite::set_link<vertex_t> set_link;
-  typedef lite::set<vertex_t, &vertex_t::set_link> set_t;
-
-  bool typed() const { return set_t::typed(this); }
-  set_t* archetype() const { return set_t::archetype(this); }
-
   bool
   bound() const {
     return false
         || table_link.bound()
+        || path_link.bound()
         || stack_link.bound()
-        || set_link.bound()
         ;;
   }
 
-  void kill() { if (!bound()) delete this; }
-
-  bool unify(vertex_t* that) {
-    if (this == that)
-      return false;
-    else if (!typed() && !that->typed())
-      (new set_t)->join(this).join(that);
-    else if (!typed())
-      set_t::archetype(that)->join(this);
-    else if (!that->typed())
-      set_t::archetype(this)->join(that);
-    else {
-      set_t* this_a = set_t::archetype(this);
-      set_t* that_a = set_t::archetype(that);
-      if (this_a == that_a)
-        return false;
-      delete this_a->conjoin(that_a);
-    }
-
-    return true;
-  }
+  bool stacked() const { return stack_link.bound(); }
 };
 
 int
@@ -96,106 +62,94 @@ main(int, char* argv[]) {
   const unsigned load = 2;
   unsigned n_vertices = 0;
 
+  lite::pool<vertex_t> vertex_pool;
+  lite::tokenizer input;
   vertex_t::table_t vertices;
+  std::vector<vertex_t*> slots;
+  std::vector<graph_t::edge_t> edges;
 
-  std::string line;
-  while (std::getline(std::cin, line)) {
-    if (line.empty() || '#' == line[0])
+  while (input.line()) {
+    const char* token = input.token();
+    if (!token || '#' == *token)
       continue;
+    const lite::symbol from(token);
 
-    std::stringstream ss(line);
-    std::string from, to;
-    ss >> from >> to;
+    if (!(token = input.token()))
+      continue;
+    const lite::symbol to(token);
 
-    vertex_t* f = vertices.get(from.c_str());
+    vertex_t* f = vertices.get(from);
     if (!f) {
       ++n_vertices;
       if (vertices.buckets() < load * n_vertices)
         vertices.reseat((load+1) * (n_vertices+1));
-      vertices.set(f = new vertex_t(from.c_str()));
+      vertices.set(f = new (vertex_pool.allocate()) vertex_t(from, slots.size()));
+      slots.push_back(f);
     }
 
-    vertex_t* t = vertices.get(to.c_str());
+    vertex_t* t = vertices.get(to);
     if (!t) {
       ++n_vertices;
       if (vertices.buckets() < load * n_vertices)
         vertices.reseat((load+1) * (n_vertices+1));
-      vertices.set(t = new vertex_t(to.c_str()));
+      vertices.set(t = new (vertex_pool.allocate()) vertex_t(to, slots.size()));
+      slots.push_back(t);
     }
 
-    f->from_edges.push(new edge_t(f, t));
+    graph_t::edge_t e = { f->slot, t->slot, 0 };
+    edges.push_back(e);
   }
 
+  graph_t graph;
+  graph.assemble(n_vertices, edges.data(), edges.size());
+  std::vector<graph_t::edge_t>().swap(edges);
+
   unsigned count = 0;
+  vertex_t::stack_t stack;
+
   for (vertex_t* i = vertices.iterator() ; i ; i = vertices.next(i)) {
-    if (i->root)
+    if (i->index)
       continue;
 
-    vertex_t::stack_t path;
+    vertex_t::path_t path;
     path.push(i);
 
     while (!path.empty()) {
       vertex_t* v = path.peek();
 
-      edge_t::from_edges_t & fe = v->from_edges;
-
-      if (!v->root) {
-        v->root = v;
-        v->index = ++count;
-        v->edge = fe.iterator();
-      } else if (v->edge) {
-          assert(v->edge->from == v);
-
-          if (!v->edge->to->index) {
-            assert(!v->edge->to->stack_link.bound());
-            path.push(v->edge->to);
-          }
-
-          v->edge = fe.next(v->edge);
+      if (!v->index) {
+        v->index = v->lowlink = ++count;
+        v->arc = graph.begin(v->slot);
+        stack.push(v);
+      } else if (v->arc != graph.end(v->slot)) {
+        vertex_t* to = slots[v->arc++->to];
+
+        if (!to->index)
+          path.push(to);
+        else if (to->stacked())
+          v->lowlink = std::min(v->lowlink, to->index);
       } else {
         path.pop();
-        assert(v->root == v);
 
-        for (edge_t* e = fe.iterator() ; e ; e = fe.next(e)) {
-          assert(e->from == v);
-          assert(e->to->index);
-          assert(e->to->root);
-
-
-          if (!e->to->root->stack_link.bound())
-            continue;
-
-          if (v->root->index <= e->to->root->index)
-            continue;
-
-          v->root = e->to->root;
-          e->to->root->unify(v);
+        if (!path.empty()) {
+          vertex_t* p = path.peek();
+          p->lowlink = std::min(p->lowlink, v->lowlink);
         }
 
-        if (v->root == v) {
-          if (v->typed()) {
-            vertex_t::set_t* s = v->archetype();
-            vertex_t* w = s->iterator();
-
-            std::cout << w->id;
-            while ((w = s->next(w)))
-              std::cout << ' ' << w->id;
-
-            std::cout << std::endl;
-          } else
-            std::cout << v->id << std::endl;
+        if (v->lowlink == v->index) {
+          vertex_t* w = stack.pop();
+          std::cout << w->id.text;
+          while (w != v) {
+            w = stack.pop();
+            std::cout << ' ' << w->id.text;
+          }
+          std::cout << std::endl;
         }
       }
     }
   }
 
-  for (vertex_t* v = vertices.iterator() ; v ;
-       v = vertices.wipe(v, &vertex_t::kill)) {
-    while (!v->from_edges.empty())
-      v->from_edges.pop()->kill();
-    if (v->typed())
-      delete &v->archetype()->dissolve();
-  }
+  vertices.forget();
 
   vertices.reseat();
   return EXIT_SUCCESS;
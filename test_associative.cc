@@ -6,28 +6,51 @@
 
 #include <lace/singleton.h>
 #include <lace/random.h>
+#include "btree.h"
+#include "cache.h"
 #include "heap.h"
 #include "table.h"
 
+static unsigned evictions = 0;
+
 struct node {
   int value;
   node(int v) : value(v) { }
 
   lite::heap_link<node> heap_link;
   lite::table_link<node> table_link;
+  lite::btree_link<node> btree_link;
+  lite::table_link<node> index_link;
+  lite::list_link<node> recency_link;
+  lite::cache_mark<node> cache_mark;
 
   bool
   bound() const {
     return false
         || heap_link.bound()
         || table_link.bound()
+        || btree_link.bound()
+        || index_link.bound()
+        || recency_link.bound()
         ;;
   }
 
   void kill() { if (!bound()) delete this; }
+  void evict() { ++evictions; kill(); }
 
   typedef lite::heap<node, &node::heap_link, typeof(node::value), &node::value> heap_t;
   typedef lite::table<node, &node::table_link, typeof(node::value), &node::value> table_t;
+  typedef lite::table<node, &node::table_link, typeof(node::value), &node::value,
+                      lace::compare<int>, lace::hash<int>, lite::table_stats> stats_table_t;
+  typedef lite::btree<node, &node::btree_link, typeof(node::value), &node::value> btree_t;
+  typedef lite::btree<node, &node::btree_link, typeof(node::value), &node::value,
+                      lace::compare<int>, 4> small_btree_t;
+  typedef lite::lru_cache<node, &node::index_link, &node::recency_link,
+                          typeof(node::value), &node::value> lru_cache_t;
+  typedef lite::clock_cache<node, &node::index_link, &node::recency_link, &node::cache_mark,
+                            typeof(node::value), &node::value> clock_cache_t;
+  typedef lite::slru_cache<node, &node::index_link, &node::recency_link, &node::cache_mark,
+                           typeof(node::value), &node::value> slru_cache_t;
 };
 
 int
@@ -85,6 +108,302 @@ main(int, char*[]) {
   table.bus(table.get(v->value))->kill();
   table.dehash();
 
+  {{
+    // one bucket, so that the iterator walks the chain
+    node::table_t t;
+    node::table_t::bucket_t bs[1];
+    t.rehash(bs, 1);
+
+    for (unsigned i = 0 ; i < 4 ; ++i)
+      t.set(new node(i));
+
+    node* first = t.iterator();
+    node* last = first;
+    while (node* n = t.next(last))
+      last = n;
+
+    // find leaves the chain alone, where get moves the hit to the front
+    assert(last != first && t.find(last->value) == last);
+    assert(t.iterator() == first);
+    assert(t.get(last->value) == last);
+    assert(t.iterator() == last);
+
+    while (node* n = t.iterator())
+      t.bus(n)->kill();
+    t.dehash();
+  }}
+
+  {{
+    node::stats_table_t t;
+    node::stats_table_t::bucket_t bs[BUCKETS];
+    t.rehash(bs, BUCKETS);
+
+    node* xs[n];
+    for (unsigned i = 0 ; i < n ; ++i)
+      t.set(xs[i] = new node(i));
+
+    for (unsigned i = 0 ; i < 2 * n ; ++i)
+      t.get(i);
+
+    const bool member = t.is_member(xs[0]);
+    assert(member);
+    (void)member;
+
+    for (unsigned i = 0 ; i < n ; ++i)
+      t.bus(xs[i])->kill();
+    t.dehash();
+
+    node::stats_table_t::stats_t s = t.stats();
+    std::cout << "stats"
+      << " gets " << s.gets
+      << " hits " << s.hits
+      << " misses " << s.misses
+      << " sets " << s.sets
+      << " buses " << s.buses
+      << " rehashes " << s.rehashes
+      << std::endl;
+
+    std::cout << "walks";
+    unsigned long long walks = 0;
+    for (unsigned i = 0 ; i < lite::table_stats::bins ; ++i) {
+      std::cout << ' ' << s.get_walks[i];
+      walks += s.get_walks[i];
+    }
+    std::cout << std::endl;
+
+    assert(s.gets == 2 * n && s.hits == n && s.misses == n);
+    assert(s.sets == n && s.buses == n && s.rehashes == 2);
+    assert(walks == s.gets);
+
+    // only the call above is recorded, not those asserted by set & bus
+    unsigned long long probes = 0;
+    for (unsigned i = 0 ; i < lite::table_stats::bins ; ++i)
+      probes += s.member_walks[i];
+    assert(1 == probes);
+    (void)probes;
+  }}
+
+  {{
+    // narrow nodes, so that a few hundred keys split & merge at every level
+    node::small_btree_t t;
+    static const unsigned m = 400;
+
+    node* xs[m];
+    for (unsigned i = 0 ; i < m ; ++i)
+      t.graft(xs[i] = new node(rng.l() % (m / 2)));
+    assert(t.size() == m);
+
+    unsigned count = 0;
+    for (node* i = t.min() ; i ; i = t.next(i), ++count)
+      assert(!t.next(i) || i->value <= t.next(i)->value);
+    assert(count == m);
+
+    for (node* i = t.max() ; i ; i = t.prev(i), --count)
+      assert(!t.prev(i) || t.prev(i)->value <= i->value);
+    assert(count == 0);
+
+    for (unsigned i = 0 ; i < m ; ++i) {
+      node* x = t.find(xs[i]->value);
+      assert(x && x->value == xs[i]->value);
+      assert(!t.prev(x) || t.prev(x)->value < x->value);
+      (void)x;
+    }
+    assert(!t.find(-1));
+    assert(!t.find(m));
+
+    std::cout << "btree";
+    for (node* i = t.min() ; i ; i = t.next(i))
+      if (i->value < 16)
+        std::cout << ' ' << i->value;
+    std::cout << std::endl;
+
+    for (unsigned i = 0 ; i < m ; i += 2)
+      t.prune(xs[i])->kill();
+    assert(t.size() == m / 2);
+
+    for (unsigned i = 1 ; i < m ; i += 2)
+      assert(t.is_member(xs[i]));
+
+    t.fell(&node::kill);
+    assert(t.empty());
+    assert(!t.min() && !t.max());
+  }}
+
+  {{
+    // the vector & branchless scans must agree with the binary search
+    typedef lite::btree_scan<int, lace::compare<int> > scan_t;
+    typedef lite::btree_scan<int, lace::compare<int>, false> search_t;
+    typedef lite::btree_scan<unsigned, lace::compare<unsigned> > uscan_t;
+    typedef lite::btree_scan<unsigned, lace::compare<unsigned>, false> usearch_t;
+    typedef lite::btree_scan<long, lace::compare<long> > lscan_t;
+    typedef lite::btree_scan<long, lace::compare<long>, false> lsearch_t;
+
+    static const unsigned m = 70;
+    int keys[m];
+    unsigned ukeys[m];
+    long lkeys[m];
+    for (unsigned i = 0 ; i < m ; ++i) {
+      keys[i] = int(i / 2) - int(m / 4);
+      ukeys[i] = 0x80000000u + keys[i];
+      lkeys[i] = keys[i];
+    }
+
+    // counted rather than asserted, so that the scans are compared in
+    // every build
+    unsigned mismatches = 0;
+    for (unsigned c = 0 ; c <= m ; ++c) {
+      for (int k = keys[0] - 1 ; k <= keys[m - 1] + 1 ; ++k) {
+        const unsigned u = 0x80000000u + k;
+        const long l = k;
+        mismatches += scan_t::lower(keys, c, k) != search_t::lower(keys, c, k);
+        mismatches += scan_t::upper(keys, c, k) != search_t::upper(keys, c, k);
+        mismatches += uscan_t::lower(ukeys, c, u) != usearch_t::lower(ukeys, c, u);
+        mismatches += uscan_t::upper(ukeys, c, u) != usearch_t::upper(ukeys, c, u);
+        mismatches += lscan_t::lower(lkeys, c, l) != lsearch_t::lower(lkeys, c, l);
+        mismatches += lscan_t::upper(lkeys, c, l) != lsearch_t::upper(lkeys, c, l);
+      }
+    }
+
+    if (mismatches)
+      return EXIT_FAILURE;
+
+    std::cout << "scan"
+      << ' ' << scan_t::lower(keys, m, 0)
+      << ' ' << scan_t::upper(keys, m, 0)
+      << std::endl;
+  }}
+
+  {{
+    node::btree_t t;
+    node* xs[n];
+    for (unsigned i = 0 ; i < n ; ++i)
+      t.graft(xs[i] = new node(n - i));
+
+    assert(t.min() == xs[n - 1]);
+    assert(t.max() == xs[0]);
+    assert(t.find(n / 2) == xs[n / 2]);
+
+    for (unsigned i = 0 ; i < n ; ++i)
+      t.prune(xs[i])->kill();
+    assert(t.empty());
+  }}
+
+  evictions = 0;
+
+  {{
+    node::lru_cache_t c(4, &node::evict);
+    for (int i = 0 ; i < 4 ; ++i)
+      c.put(new node(i));
+
+    assert(c.full());
+    node* hit = c.get(0);
+    assert(hit && 0 == hit->value);
+    (void)hit;
+    c.put(new node(4));
+
+    assert(1 == evictions);
+    assert(!c.peek(1));
+    assert(c.peek(0) && c.peek(4));
+
+    c.put(new node(5));
+    assert(!c.peek(2));
+    assert(c.size() == c.capacity());
+
+    std::cout << "lru";
+    for (int i = 0 ; i < 6 ; ++i)
+      std::cout << ' ' << (c.peek(i) ? i : -1);
+    std::cout << std::endl;
+
+    c.fell(&node::kill);
+  }}
+
+  {{
+    node::clock_cache_t c(4, &node::evict);
+    for (int i = 0 ; i < 4 ; ++i)
+      c.put(new node(i));
+
+    const bool hits = c.get(0) && c.get(2);
+    assert(hits);
+    (void)hits;
+
+    // the hand clears 0, takes 1, then clears 2 & takes 3
+    c.put(new node(4));
+    assert(!c.peek(1));
+    c.put(new node(5));
+    assert(!c.peek(3));
+    assert(c.peek(0) && c.peek(2));
+    assert(4 == evictions);
+
+    std::cout << "clock";
+    for (int i = 0 ; i < 6 ; ++i)
+      std::cout << ' ' << (c.peek(i) ? i : -1);
+    std::cout << std::endl;
+
+    c.fell(&node::kill);
+  }}
+
+  {{
+    node::slru_cache_t c(5, &node::evict);
+    for (int i = 0 ; i < 5 ; ++i)
+      c.put(new node(i));
+
+    const bool hits = c.get(0) && c.get(1);
+    assert(hits);
+    (void)hits;
+    assert(2 == c.shielded());
+
+    // a scan of keys used once cycles through probation only
+    for (int i = 5 ; i < 100 ; ++i)
+      c.put(new node(i));
+
+    assert(c.peek(0) && c.peek(1));
+    assert(c.size() == c.capacity());
+
+    // promoting three more overflows the protected segment, demoting 0
+    unsigned promoted = 0;
+    for (int i = 97 ; i < 100 ; ++i)
+      promoted += !!c.get(i);
+    assert(3 == promoted);
+    assert(4 == c.shielded());
+    assert(c.peek(0) && c.peek(1));
+
+    std::cout << "slru " << c.shielded() << ' ' << evictions << std::endl;
+
+    c.fell(&node::kill);
+  }}
+
+  {{
+    node::lru_cache_t l(16, &node::evict);
+    node::clock_cache_t k(16, &node::evict);
+    node::slru_cache_t s(16, &node::evict);
+
+    evictions = 0;
+    unsigned puts = 0;
+    for (unsigned i = 0 ; i < 1000 ; ++i) {
+      const int x = rng.l() % 48;
+      if (!l.get(x)) {
+        l.put(new node(x));
+        ++puts;
+      }
+      if (!k.get(x)) {
+        k.put(new node(x));
+        ++puts;
+      }
+      if (!s.get(x)) {
+        s.put(new node(x));
+        ++puts;
+      }
+      assert(l.size() <= l.capacity());
+      assert(s.shielded() <= s.size());
+    }
+
+    assert(puts == evictions + l.size() + k.size() + s.size());
+
+    l.fell(&node::kill);
+    k.fell(&node::kill);
+    s.fell(&node::kill);
+  }}
+
   return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,188 @@
+#include <cstdlib>
+#include <cassert>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+#include <unistd.h>
+
+#include "set.h"
+#include "skiplist.h"
+#include "tree.h"
+
+struct node {
+  unsigned value;
+  node() : value(0) { }
+
+  lite::atomic_forest_link<node> forest_link;
+  lite::skiplist_link<node> skiplist_link;
+  lite::tree_link<node> tree_link;
+
+  bool
+  bound() const {
+    return false
+        || forest_link.bound()
+        || skiplist_link.bound()
+        || tree_link.bound()
+        ;;
+  }
+
+  typedef lite::atomic_forest<node, &node::forest_link> forest_t;
+  typedef lite::skiplist<node, &node::skiplist_link, typeof(node::value), &node::value> skiplist_t;
+  typedef lite::concurrent_tree<node, &node::tree_link, typeof(node::value), &node::value> tree_t;
+};
+
+static const unsigned n = 1 << 14;
+static const unsigned components = 7;
+static const unsigned threads = 4;
+static const unsigned m = 1 << 10; // the tree checks itself on every change
+
+static node nodes[n];
+static node::skiplist_t skiplist;
+static node::tree_t tree;
+static std::atomic<bool> churning;
+
+void
+join(unsigned t) {
+  for (unsigned i = t ; i + components < n ; i += threads) {
+    unsigned j = (i * 2654435761u) % (n - components);
+    node::forest_t::join(&nodes[i + components], &nodes[i]);
+    node::forest_t::join(&nodes[j], &nodes[j + components]);
+    assert(node::forest_t::contains(&nodes[i], &nodes[i + components]));
+  }
+}
+
+// every thread inserts keys interleaved with the others', checking that
+// what it has inserted can be found
+void
+insert(unsigned t) {
+  for (unsigned i = t ; i < n ; i += threads) {
+    skiplist.insert(&nodes[i]);
+    node* x = skiplist.find(nodes[i].value);
+    assert(x && x->value == nodes[i].value);
+    (void)x;
+  }
+}
+
+// the even keys stay put while the odd ones are grafted & pruned around
+// them, so every rotation runs past the readers; the odd nodes are grafted
+// again while readers may still be on them, which is safe as their keys
+// never change
+void
+churn() {
+  for (unsigned round = 0 ; round < 8 ; ++round) {
+    for (unsigned i = 1 ; i < m ; i += 2)
+      tree.graft(&nodes[i]);
+    for (unsigned i = 1 ; i < m ; i += 2)
+      tree.prune(&nodes[i]);
+  }
+  churning.store(false);
+}
+
+void
+find(unsigned t) {
+  do {
+    for (unsigned i = t * 2 ; i < m ; i += threads * 2) {
+      node* x = tree.find(i);
+      if (!x || x != &nodes[i])
+        abort();
+    }
+  } while (churning.load());
+}
+
+int
+main(int, char*[]) {
+  for (unsigned i = 0 ; i < n ; ++i)
+    nodes[i].value = i;
+
+  {{
+    std::thread ts[threads];
+    for (unsigned t = 0 ; t < threads ; ++t)
+      ts[t] = std::thread(join, t);
+    for (unsigned t = 0 ; t < threads ; ++t)
+      ts[t].join();
+  }}
+
+  std::cout << "forest" << '\t';
+  for (unsigned i = 0 ; i < components ; ++i) {
+    node* a = node::forest_t::archetype(&nodes[i]);
+    for (unsigned j = 0 ; j < n ; ++j)
+      if (node::forest_t::contains(&nodes[j], &nodes[i]) != (j % components == i))
+        return EXIT_FAILURE;
+    std::cout << ' ' << a->value;
+  }
+  std::cout << std::endl;
+
+  for (unsigned i = 0 ; i < n ; ++i)
+    node::forest_t::dissolve(&nodes[i]);
+
+  for (unsigned i = 0 ; i < n ; ++i)
+    nodes[i].value = (i * 2654435761u) % (n / 2);
+
+  {{
+    std::thread ts[threads];
+    for (unsigned t = 0 ; t < threads ; ++t)
+      ts[t] = std::thread(insert, t);
+    for (unsigned t = 0 ; t < threads ; ++t)
+      ts[t].join();
+  }}
+
+  if (skiplist.size() != n)
+    return EXIT_FAILURE;
+
+  unsigned count = 0;
+  for (node* x = skiplist.first() ; x ; x = skiplist.next(x), ++count)
+    if (skiplist.next(x) && skiplist.next(x)->value < x->value)
+      return EXIT_FAILURE;
+  if (count != n)
+    return EXIT_FAILURE;
+
+  for (unsigned i = 0 ; i < n ; i += 2)
+    skiplist.erase(&nodes[i]);
+
+  static bool kept[n / 2];
+  for (unsigned i = 1 ; i < n ; i += 2)
+    kept[nodes[i].value] = true;
+
+  for (unsigned k = 0 ; k < n / 2 ; ++k) {
+    node* x = skiplist.find(k);
+    if (!x != !kept[k] || (x && (x->value != k || !x->skiplist_link.bound())))
+      return EXIT_FAILURE;
+    node* y = skiplist.lower_bound(k);
+    if (y && y->value < k)
+      return EXIT_FAILURE;
+  }
+
+  std::cout << "skiplist" << '\t' << ' ' << skiplist.size()
+    << ' ' << skiplist.first()->value << std::endl;
+
+  skiplist.fell();
+
+  for (unsigned i = 0 ; i < m ; ++i)
+    nodes[i].value = i;
+  for (unsigned i = 0 ; i < m ; i += 2)
+    tree.graft(&nodes[i]);
+
+  {{
+    churning.store(true);
+    std::thread writer(churn);
+    std::thread ts[threads];
+    for (unsigned t = 0 ; t < threads ; ++t)
+      ts[t] = std::thread(find, t);
+    writer.join();
+    for (unsigned t = 0 ; t < threads ; ++t)
+      ts[t].join();
+  }}
+
+  for (unsigned i = 0 ; i < m ; ++i)
+    if (!tree.find(i) != bool(i % 2))
+      return EXIT_FAILURE;
+
+  std::cout << "tree" << '\t' << ' ' << tree.find(m / 2)->value << std::endl;
+
+  tree.fell();
+
+  return EXIT_SUCCESS;
+}
+
+//
@@ -7,6 +7,7 @@
 #include <lace/singleton.h>
 #include <lace/random.h>
 #include "set.h"
+#include "pool.h"
 #include "tree.h"
 #include "heap.h"
 #include "stack.h"
@@ -17,6 +18,7 @@ struct node {
   node(int v) : value(v) { }
 
   lite::set_link<node> set_link;
+  lite::forest_link<node> forest_link;
   lite::tree_link<node> tree_link;
   lite::heap_link<node> heap_link;
   lite::queue_link<node> queue_link;
@@ -26,6 +28,7 @@ struct node {
   bound() const {
     return false
         || set_link.bound()
+        || forest_link.bound()
         || tree_link.bound()
         || heap_link.bound()
         || queue_link.bound()
@@ -36,8 +39,12 @@ struct node {
   void kill() { if (!bound()) delete this; }
 
   typedef lite::set<node, &node::set_link> set_t;
+  typedef lite::forest<node, &node::forest_link> forest_t;
   typedef lite::tree<node, &node::tree_link, typeof(node::value), &node::value> tree_t;
   typedef lite::heap<node, &node::heap_link, typeof(node::value), &node::value> heap_t;
+  typedef lite::bounded_heap<node, &node::heap_link, typeof(node::value), &node::value> bounded_heap_t;
+  typedef lite::tree<node, &node::tree_link, typeof(node::value), &node::value, lace::compare<int>, lite::tree_stats> stats_tree_t;
+  typedef lite::heap<node, &node::heap_link, typeof(node::value), &node::value, lace::compare<int>, lite::heap_stats> stats_heap_t;
   typedef lite::queue<node, &node::queue_link> queue_t;
   typedef lite::stack<node, &node::stack_link> stack_t;
 };
@@ -167,6 +174,58 @@ main(int, char*[]) {
     heap.sift(zz)->kill();
   }}
 
+  {{
+    node::bounded_heap_t top(n / 4);
+    for (node* i = tree.min() ; i ; i = tree.next(i))
+      if (node* x = top.inhume(new node(i->value)))
+        x->kill();
+    assert(top.full());
+
+    node::stack_t s;
+    top.drain_sorted(s);
+    assert(top.empty());
+
+    std::cout << "top" << '\t';
+    assert(s.peek()->value == tree.max()->value);
+    while (!s.empty()) {
+      node* x = s.pop();
+      assert(s.empty() || s.peek()->value <= x->value);
+      std::cout << ' ' << x->value;
+      x->kill();
+    }
+    std::cout << std::endl;
+  }}
+
+  {{
+    node* parity[2] = { NULL, NULL };
+    unsigned count[2] = { 0, 0 };
+
+    for (node* i = tree.min() ; i ; i = tree.next(i)) {
+      unsigned p = (unsigned)i->value % 2;
+      if (!parity[p])
+        parity[p] = i;
+      else if (!node::forest_t::join(parity[p], i))
+        assert(!"unreachable");
+      ++count[p];
+    }
+
+    for (unsigned p = 0 ; p < 2 ; ++p) {
+      if (!parity[p])
+        continue;
+
+      unsigned members = 0;
+      for (node* i = parity[p] ; i ; i = node::forest_t::next(parity[p], i)) {
+        assert(node::forest_t::contains(i, parity[p]));
+        assert(!parity[!p] || !node::forest_t::contains(i, parity[!p]));
+        ++members;
+      }
+      assert(members == count[p]);
+
+      node::forest_t::dissolve(parity[p]);
+      assert(!node::forest_t::typed(parity[p]));
+    }
+  }}
+
   std::cout << "heap" << '\t';
   for (node* i = tree.min() ; i ; i = tree.next(i)) {
     node* x = heap.exhume();
@@ -235,6 +294,124 @@ main(int, char*[]) {
     z->kill();
   }}
 
+  {{
+    lite::pool<node> pool;
+    node::tree_t t;
+    node::heap_t h;
+    node::queue_t q;
+    node::stack_t s;
+    node::set_t e;
+
+    for (unsigned i = 0 ; i < n ; ++i) {
+      node* x = new (pool.allocate()) node(rng.l() % 100);
+      t.graft(x);
+      h.inhume(x);
+      q.enqueue(x);
+      s.push(x);
+      if (x->value % 2)
+        e.join(x);
+    }
+    assert(pool.size() == n);
+
+    t.forget();
+    h.forget();
+    q.forget();
+    s.forget();
+    e.forget();
+
+    assert(t.empty() && h.empty() && q.empty() && s.empty() && e.empty());
+    std::cout << "forget" << '\t' << ' ' << pool.size() << std::endl;
+  }}
+
+  {{
+    lite::pool<node> pool;
+    node::stats_tree_t t;
+    node::stats_heap_t h;
+
+    // ascending keys are the worst case for both
+    for (unsigned i = 0 ; i < n ; ++i) {
+      node* x = new (pool.allocate()) node(i);
+      t.graft(x);
+      h.inhume(x);
+    }
+
+    unsigned found = 0;
+    for (unsigned i = 0 ; i <= n ; ++i)
+      found += !!t.find(i);
+    assert(found == n);
+
+    node::stats_tree_t::stats_t ts = t.stats();
+    std::cout << "stats" << '\t'
+      << " grafts " << ts.grafts
+      << " rotations " << ts.rotations
+      << " recolors " << ts.recolors
+      << " fixups " << ts.graft_fixups
+      << " finds " << ts.finds
+      << std::endl;
+
+    assert(ts.grafts == n);
+    assert(ts.rotations > 0);
+    assert(ts.graft_fixups >= n);
+    assert(ts.finds == n + 1);
+
+    unsigned long long finds = 0;
+    for (unsigned b = 0 ; b < lite::tree_stats::bins ; ++b)
+      finds += ts.depths[b];
+    assert(finds == ts.finds);
+    assert(ts.depths[0] == 1);
+
+    while (!t.empty())
+      t.prune(t.root());
+    assert(t.stats().prunes == n);
+
+    // every node but the first is a child of the root
+    node* x = h.exhume();
+    assert(0 == x->value);
+    (void)x;
+
+    node* z = h.next(h.root());
+    z->value = -1;
+    h.rehume(z);
+    assert(z == h.root());
+
+    node::stats_heap_t::stats_t hs = h.stats();
+    std::cout << "stats" << '\t'
+      << " passes " << hs.passes
+      << " children " << hs.pass_children
+      << " rehumes " << hs.rehumes
+      << " siblings " << hs.parent_siblings
+      << std::endl;
+
+    assert(hs.passes >= 1);
+    assert(hs.pass_children >= n - 1);
+    assert(hs.rehumes == 1);
+
+    h.forget();
+  }}
+
+  {{
+    // a heap deep & wide enough that validation must be linear, as every
+    // change is checked when assertions are enabled
+    static const unsigned m = 1 << 12;
+    node::heap_t h;
+
+    for (unsigned i = 0 ; i < m ; ++i)
+      h.inhume(new node(rng.l() % m));
+
+    int last = -1;
+    unsigned count = 0;
+    while (!h.empty()) {
+      node* x = h.exhume();
+      if (x->value < last)
+        return EXIT_FAILURE;
+      last = x->value;
+      ++count;
+      x->kill();
+    }
+
+    std::cout << "deep" << '\t' << ' ' << count << std::endl;
+  }}
+
   return EXIT_SUCCESS;
 }
 
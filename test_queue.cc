@@ -1,6 +1,8 @@
 #include <cstdlib>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 #include <unistd.h>
 
@@ -30,6 +32,32 @@ struct node {
 
   typedef forward_queue_t::sorter<typeof(value), &node::value> forward_sorter_t;
   typedef reverse_queue_t::reverse_sorter<typeof(value), &node::value> reverse_sorter_t;
+  typedef forward_queue_t::radix_sorter<typeof(value), &node::value> radix_sorter_t;
+  typedef forward_queue_t::sorter<typeof(value), &node::value,
+                                  lite::functor_compare<int, std::greater<int> > > greater_sorter_t;
+};
+
+// keyed on key alone, with seq recording input order to check stability
+struct item {
+  int key;
+  unsigned seq;
+  item(int k, unsigned s) : key(k), seq(s) { }
+
+  lite::queue_link<item> link;
+
+  typedef lite::queue<item, &item::link> queue_t;
+  typedef queue_t::sorter<typeof(key), &item::key> sorter_t;
+};
+
+struct word {
+  const char* value;
+  word(const char* v) : value(v) { }
+
+  lite::queue_link<word> link;
+
+  typedef lite::queue<word, &word::link> queue_t;
+  typedef queue_t::sorter<typeof(value), &word::value> sorter_t;
+  typedef queue_t::radix_sorter<typeof(value), &word::value> radix_sorter_t;
 };
 
 int
@@ -84,6 +112,142 @@ main(int, char*[]) {
 
   reverse.reverse();
 
+  {{
+    static const unsigned m = 1 << 16;
+
+    node::forward_queue_t parallel;
+    for (unsigned i = 0 ; i < m ; ++i)
+      parallel.enqueue(new node(rng.l() % m));
+
+    node::forward_sorter_t::sort(parallel, 4);
+    assert(parallel.size() == m);
+    assert(node::forward_sorter_t::sorted(parallel));
+
+    while (!parallel.empty())
+      parallel.dequeue()->kill();
+  }}
+
+  {{
+    static const unsigned m = 1 << 12;
+
+    node::forward_queue_t natural;
+    for (unsigned i = 0 ; i < m ; ++i)
+      natural.enqueue(new node(i % 512 ? i + rng.l() % 4 : m - i));
+
+    node::forward_sorter_t::natural_sort(natural);
+    assert(natural.size() == m);
+    assert(node::forward_sorter_t::sorted(natural));
+
+    while (!natural.empty())
+      natural.dequeue()->kill();
+  }}
+
+  {{
+    // few distinct keys, in non-descending runs full of ties, strictly
+    // descending runs, & stretches of noise, of varied lengths so that
+    // runs are merged at every position of the run stack
+    static const unsigned m = 1 << 14;
+
+    item::queue_t items;
+    unsigned seq = 0;
+    while (seq < m) {
+      const unsigned length = 1 + rng.l() % 200;
+      const int base = rng.l() % 8;
+      for (unsigned j = 0 ; j < length ; ++j, ++seq) {
+        switch (seq / 64 % 3) {
+        case 0: items.enqueue(new item(base + j / 16, seq)); break;
+        case 1: items.enqueue(new item(base + 8 - int(j % 8), seq)); break;
+        default: items.enqueue(new item(rng.l() % 8, seq)); break;
+        }
+      }
+    }
+
+    item::sorter_t::natural_sort(items);
+    if (items.size() != seq)
+      return EXIT_FAILURE;
+
+    for (item* i = items.peek() ; items.next(i) ; i = items.next(i)) {
+      const item* n = items.next(i);
+      if (n->key < i->key || (n->key == i->key && n->seq < i->seq))
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "stable " << items.size() << std::endl;
+
+    while (!items.empty())
+      delete items.dequeue();
+  }}
+
+  {{
+    static const unsigned m = 1 << 12;
+
+    node::forward_queue_t radix;
+    for (unsigned i = 0 ; i < m ; ++i)
+      radix.enqueue(new node(rng.l() % m - m / 2));
+
+    node::radix_sorter_t::sort(radix);
+    assert(radix.size() == m);
+    assert(node::forward_sorter_t::sorted(radix));
+
+    while (!radix.empty())
+      radix.dequeue()->kill();
+  }}
+
+  {{
+    static const unsigned m = 1 << 14;
+
+    // every suffix of a run of one letter, so each is a prefix of the
+    // next longer, & random words alongside
+    std::vector<char> letters(m + 1, 'a');
+    letters[m] = '\0';
+
+    std::vector<char> text(m * 4);
+    for (unsigned i = 0 ; i < m ; ++i) {
+      for (unsigned j = 0 ; j < 3 ; ++j)
+        text[i * 4 + j] = 'a' + rng.l() % 3;
+      text[i * 4 + 3] = '\0';
+    }
+
+    word::queue_t words;
+    for (unsigned i = 0 ; i < m ; ++i) {
+      words.enqueue(new word(&letters[i]));
+      words.enqueue(new word(&text[i * 4 + rng.l() % 4]));
+    }
+
+    word::radix_sorter_t::sort(words);
+    assert(words.size() == 2 * m);
+    assert(word::sorter_t::sorted(words));
+
+    std::cout << "words " << strlen(words.peek()->value) << std::endl;
+
+    while (!words.empty())
+      delete words.dequeue();
+  }}
+
+  {{
+    typedef lite::order<int, lite::functor_compare<int, std::greater<int> > > greater_t;
+    typedef lite::order<int, lace::compare<int> > less_t;
+    if (!(greater_t::backward() && greater_t::less(2, 1) && !greater_t::less(1, 1)))
+      return EXIT_FAILURE;
+    if (!(less_t::forward() && less_t::less(1, 2) && less_t::equal(1, 1)))
+      return EXIT_FAILURE;
+
+    static const unsigned m = 1 << 12;
+
+    node::forward_queue_t greater;
+    for (unsigned i = 0 ; i < m ; ++i)
+      greater.enqueue(new node(rng.l() % m));
+
+    node::greater_sorter_t::sort(greater);
+    assert(greater.size() == m);
+    assert(node::greater_sorter_t::sorted(greater));
+    for (node* i = greater.peek() ; greater.next(i) ; i = greater.next(i))
+      assert(i->value >= greater.next(i)->value);
+
+    while (!greater.empty())
+      greater.dequeue()->kill();
+  }}
+
   return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,153 @@
+#ifndef LITE__TOKENIZER_H
+#define LITE__TOKENIZER_H
+
+#include <lace/do_not_copy.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace lite {
+
+// whitespace-separated tokens, terminated in place; every token stays
+// valid for the lifetime of the tokenizer
+class tokenizer : public lace::do_not_copy {
+public:
+  tokenizer(int fd = STDIN_FILENO)
+    : buffer_(NULL)
+    , length_(0)
+    , mapped_(false)
+    , next_(NULL)
+    , cursor_(NULL)
+    , eol_(NULL)
+  {
+    if (!map(fd))
+      slurp(fd);
+
+    next_ = buffer_;
+  }
+
+  ~tokenizer() {
+    if (mapped_)
+      munmap(buffer_, length_);
+    else
+      free(buffer_);
+  }
+
+  // advance to the next line, returning false at the end of input
+  bool line() {
+    if (next_ >= buffer_ + length_)
+      return false;
+
+    cursor_ = next_;
+    eol_ = static_cast<char*>(memchr(cursor_, '\n', buffer_ + length_ - cursor_));
+    if (!eol_)
+      eol_ = buffer_ + length_;
+
+    *eol_ = '\0';
+    next_ = eol_ + 1;
+    return true;
+  }
+
+  // next token on the current line, or NULL if there are no more
+  const char* token() {
+    assert(cursor_);
+
+    while (cursor_ < eol_ && space(*cursor_))
+      ++cursor_;
+
+    if (cursor_ == eol_)
+      return NULL;
+
+    const char* t = cursor_;
+    while (cursor_ < eol_ && !space(*cursor_))
+      ++cursor_;
+
+    if (cursor_ < eol_)
+      *cursor_++ = '\0';
+
+    return t;
+  }
+
+  bool mapped() const { return mapped_; }
+
+private:
+  char* buffer_;
+  size_t length_;
+  bool mapped_;
+
+  char* next_;
+  char* cursor_;
+  char* eol_;
+
+  static bool space(char c) { return ' ' == c || '\t' == c || '\r' == c; }
+
+  // a private mapping is written in place, relying on the zeroed tail
+  // of the last page to hold the final terminator; only a descriptor at
+  // the start of its file is mapped, & it is left at the end, as reading
+  // would leave it
+  bool map(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || !st.st_size)
+      return false;
+
+    if (lseek(fd, 0, SEEK_CUR))
+      return false;
+
+    const size_t page = sysconf(_SC_PAGESIZE);
+    if (!(st.st_size % page))
+      return false;
+
+    void* p = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == p)
+      return false;
+
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    lseek(fd, 0, SEEK_END);
+
+    buffer_ = static_cast<char*>(p);
+    length_ = st.st_size;
+    mapped_ = true;
+    return true;
+  }
+
+  void slurp(int fd) {
+    size_t capacity = 1 << 20;
+    buffer_ = static_cast<char*>(malloc(capacity + 1));
+    if (!buffer_)
+      abort();
+
+    for (;;) {
+      if (length_ == capacity) {
+        capacity *= 2;
+        char* b = static_cast<char*>(realloc(buffer_, capacity + 1));
+        if (!b)
+          abort();
+        buffer_ = b;
+      }
+
+      ssize_t n = read(fd, buffer_ + length_, capacity - length_);
+      if (n > 0)
+        length_ += n;
+      else if (!n)
+        break;
+      else if (EINTR != errno) {
+        // a partial input would pass for a complete one, so give up
+        perror("read");
+        abort();
+      }
+    }
+
+    buffer_[length_] = '\0';
+  }
+};
+
+} // namespace lite
+
+#endif//LITE__TOKENIZER_H
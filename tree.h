@@ -3,12 +3,17 @@
 
 #include <lace/do_not_copy.h>
 #include "link.h"
+#include "order.h"
 
 #include <lace/compare.h>
 
 #include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace lite {
 
@@ -17,8 +22,12 @@ class tree_link {
 public:
   typedef tree_link type;
   template <class T, typename tree_link<T>::type T::*L,
-            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &)>
+            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &),
+            class S>
     friend class tree;
+  template <class T, typename tree_link<T>::type T::*L,
+            typename K, K T::*key, lace::compare_t (*C)(K const &, K const &)>
+    friend class concurrent_tree;
 
   bool bound() const {
     assert(p.p || (!l.p && !r.p));
@@ -30,10 +39,57 @@ private:
   link<X> l, r;
 };
 
+// the default statistics policy, which records nothing & costs nothing
+struct tree_nostats {
+  struct snapshot_t { };
+
+  void grafted(size_t) const { }
+  void pruned(size_t) const { }
+  void rotated() const { }
+  void recolored() const { }
+  void found(size_t) const { }
+
+  snapshot_t snapshot() const { return snapshot_t(); }
+};
+
+// counts rebalancing work, ie rotations, recolorings & passes through the
+// fix-up loops of graft & prune, with a histogram of the depth at which
+// each find ended; the last bin holds every deeper search
+struct tree_stats {
+  static const unsigned bins = 64;
+
+  struct snapshot_t {
+    unsigned long long grafts, prunes, rotations, recolors;
+    unsigned long long graft_fixups, prune_fixups;
+    unsigned long long finds;
+    unsigned long long depths[bins];
+  };
+
+  tree_stats() { memset(&counts_, 0, sizeof(counts_)); }
+
+  void grafted(size_t fixups) const { ++counts_.grafts; counts_.graft_fixups += fixups; }
+  void pruned(size_t fixups) const { ++counts_.prunes; counts_.prune_fixups += fixups; }
+  void rotated() const { ++counts_.rotations; }
+  void recolored() const { ++counts_.recolors; }
+  void found(size_t depth) const { ++counts_.finds; ++counts_.depths[depth < bins ? depth : bins - 1]; }
+
+  snapshot_t snapshot() const { return counts_; }
+
+private:
+  mutable snapshot_t counts_;
+};
+
 template <class T, typename tree_link<T>::type T::*L,
-          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &) = lace::compare<K> >
-class tree : public lace::do_not_copy {
+          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &) = lace::compare<K>,
+          class S = tree_nostats>
+class tree : public lace::do_not_copy, private S {
+  template <class U, typename tree_link<U>::type U::*M,
+            typename J, J U::*k, lace::compare_t (*D)(J const &, J const &)>
+    friend class concurrent_tree;
+
 public:
+  typedef typename S::snapshot_t stats_t;
+
   tree() : root_(NULL) { }
   ~tree() { assert(empty()); }
 
@@ -51,18 +107,20 @@ public:
     T ** i = &root_;
     while (*i) {
       (t->*L).p.p = *i;
-      i = compare(t, *i) < 0
+      i = before(t, *i)
         ? &((*i)->*L).l.p
         : &((*i)->*L).r.p
         ;
     }
-    *i = t;
+    publish(*i, t);
 
     assert(is_red(t));
 
+    size_t fixups = 0;
     T* n = t;
     while (true) {
       assert(n);
+      ++fixups;
 
       // case 1
       T* p = parent_(n);
@@ -147,6 +205,8 @@ public:
       n = g; // to case 1
     }
 
+    S::grafted(fixups);
+
     assert(is_member(t));
     assert(is_bound(t));
     assert(!empty());
@@ -180,6 +240,8 @@ public:
       else
         unlink(t);
 
+      S::pruned(0);
+
       assert(!is_bound(t));
       assert(valid());
 
@@ -194,6 +256,8 @@ public:
       assert(c);
       set_black(c);
 
+      S::pruned(0);
+
       assert(!is_bound(t));
       assert(valid());
 
@@ -203,8 +267,10 @@ public:
     // t acts as null leaf
 
     // !case 1
+    size_t fixups = 0;
     T* n = c ? c : t;
     while (!is_root(n)) {
+      ++fixups;
       T* p = parent_(n);
       T* s = peer(n);
 
@@ -288,6 +354,8 @@ public:
     if (!c)
       unlink(t);
 
+    S::pruned(fixups);
+
     assert(!is_bound(t));
     assert(valid());
 
@@ -305,8 +373,8 @@ public:
 
     assert(is_red(n));
     if (is_black(o)) {
-      set_red(o);
-      set_black(n);
+      toggle(o);
+      toggle(n);
     }
 
     if (left_(o))
@@ -450,32 +518,91 @@ public:
   }
 
   T* find(const K & k) const {
+    if (order_t::natural())
+      return descend(k);
+
     T* n = root();
 
+    size_t depth = 0;
     while (n) {
       lace::compare_t v = C(k, n->*key);
       switch((0<v)-(v<0)) {
       case -1: n = left(n); break;
-      case  0: return n;
+      case  0: S::found(depth); return n;
       case  1: n = right(n); break;
       default: assert(!"unreachable"), __builtin_unreachable();
       }
+      ++depth;
     }
 
+    S::found(depth);
     return NULL;
   }
 
+  // empties the tree without pruning, leaving the nodes' links stale
+  tree & forget() { publish(root_, NULL); return *this; }
+
+  stats_t stats() const { return S::snapshot(); }
+
 private:
+  typedef order<K, C> order_t;
+
   T * root_;
 
+  static bool before(const T* foo, const T* bar) {
+    return order_t::less(foo->*key, bar->*key);
+  }
+
+  // the root & child links are stored atomically, with release, so that a
+  // concurrent_tree's readers can follow them while a writer changes them;
+  // on common hardware this is an ordinary store
+  static void publish(T* & link, T* n) { __atomic_store_n(&link, n, __ATOMIC_RELEASE); }
+  static T* published(T* const & link) { return __atomic_load_n(&link, __ATOMIC_ACQUIRE); }
+
+  // find for a concurrent_tree's readers, which may meet a rotation half
+  // done, & so a momentary cycle; gives up after limit steps
+  T* search(const K & k, size_t limit) const {
+    T* n = published(root_);
+    while (n && limit--) {
+      lace::compare_t v = C(k, n->*key);
+      if (v < 0)
+        n = published((n->*L).l.p);
+      else if (v > 0)
+        n = published((n->*L).r.p);
+      else
+        return n;
+    }
+    return NULL;
+  }
+
+  // as find, but testing the builtin operators' flags directly instead of
+  // the sign of a three-way result
+  T* descend(const K & k) const {
+    T* n = root_;
+
+    size_t depth = 0;
+    while (n) {
+      if (order_t::less(k, n->*key))
+        n = (n->*L).l.p;
+      else if (order_t::less(n->*key, k))
+        n = (n->*L).r.p;
+      else
+        break;
+      ++depth;
+    }
+
+    S::found(depth);
+    return n;
+  }
+
   static bool is_red(const T* n) { return n && !(n->*L).p.tagged(); }
   static bool is_black(const T* n) { return !n || (n->*L).p.tagged(); }
   static bool is_bound(const T* n) { assert(n); return (n->*L).bound(); }
 
   static void toggle(T* n) { assert(n); (n->*L).p.toggle(); }
 
-  static void set_red(T* n) { assert(is_black(n)); toggle(n); }
-  static void set_black(T* n) { assert(is_red(n)); toggle(n); }
+  void set_red(T* n) const { assert(is_black(n)); toggle(n); S::recolored(); }
+  void set_black(T* n) const { assert(is_red(n)); toggle(n); S::recolored(); }
 
   static T* parent_(const T* n) { assert(n); return (n->*L).p.tagless(); }
   static T* left_(const T* n) { assert(n); return (n->*L).l.p; }
@@ -539,7 +666,7 @@ private:
   }
 
   void link_root(T* n) {
-    root_ = n;
+    publish(root_, n);
     if (n)
       link_parent(NULL, n);
   }
@@ -548,14 +675,14 @@ private:
     assert(p);
     if (c)
       link_parent(p, c);
-    (p->*L).l.p = c;
+    publish((p->*L).l.p, c);
   }
 
   void link_right(T* p, T* c) {
     assert(p);
     if (c)
       link_parent(p, c);
-    (p->*L).r.p = c;
+    publish((p->*L).r.p, c);
   }
 
   void link_parent(T* p, T* c) {
@@ -563,10 +690,11 @@ private:
     bool black = is_black(c);
     (c->*L).p.p = p;
     if (black)
-      set_black(c);
+      toggle(c);
   }
 
   void rotate_left(T* p) {
+    S::rotated();
     T* g = parent_(p);
     T* n = right_(p);
     T* c = left_(n);
@@ -582,6 +710,7 @@ private:
   }
 
   void rotate_right(T* p) {
+    S::rotated();
     T* g = parent_(p);
     T* n = left_(p);
     T* c = right_(n);
@@ -735,6 +864,99 @@ private:
 
 };
 
+// tree whose find runs alongside graft & prune, which serialize on a
+// mutex; a writer holds the sequence odd while it works, & a reader
+// retries if the sequence moved while it searched, falling back on the
+// mutex should writers keep it busy.  A reader may still be on a node
+// just pruned, so the node must not be freed, nor its key changed, until
+// every find begun before the prune has returned; grafting it again with
+// its key unchanged is safe, since its links are only ever published
+// atomically, the step limit breaks any cycle the reader is led into, &
+// the prune alone moves the sequence under that reader
+template <class T, typename tree_link<T>::type T::*L,
+          typename K, K T::*key, lace::compare_t (*C)(K const &, K const &) = lace::compare<K> >
+class concurrent_tree : public lace::do_not_copy {
+public:
+  typedef tree<T, L, K, key, C> tree_t;
+
+  concurrent_tree() : sequence_(0) { }
+
+  bool empty() const {
+    std::lock_guard<std::mutex> lock(writer_);
+    return tree_.empty();
+  }
+
+  concurrent_tree & graft(T* t) {
+    std::lock_guard<std::mutex> lock(writer_);
+    begin();
+    tree_.graft(t);
+    end();
+    return *this;
+  }
+
+  T* prune(T* t) {
+    std::lock_guard<std::mutex> lock(writer_);
+    begin();
+    tree_.prune(t);
+    end();
+    return t;
+  }
+
+  T* find(const K & k) const {
+    for (unsigned i = 0 ; i < retries ; ++i) {
+      unsigned s = sequence_.load(std::memory_order_acquire);
+      if (s & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      T* n = tree_.search(k, limit);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == s)
+        return n;
+    }
+
+    std::lock_guard<std::mutex> lock(writer_);
+    return tree_.find(k);
+  }
+
+  typedef typename tree_t::axe_t axe_t;
+
+  concurrent_tree & fell(const axe_t a = NULL) {
+    std::lock_guard<std::mutex> lock(writer_);
+    begin();
+    tree_.fell(a);
+    end();
+    return *this;
+  }
+
+  concurrent_tree & forget() {
+    std::lock_guard<std::mutex> lock(writer_);
+    begin();
+    tree_.forget();
+    end();
+    return *this;
+  }
+
+private:
+  // a red-black tree of 2^64 nodes is at most 128 deep
+  static const size_t limit = 2 * 64;
+  static const unsigned retries = 8;
+
+  tree_t tree_;
+  mutable std::mutex writer_;
+  std::atomic<unsigned> sequence_;
+
+  void begin() {
+    sequence_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void end() {
+    sequence_.fetch_add(1, std::memory_order_release);
+  }
+};
+
 } // namespace lite
 
 #endif//LITE__TREE